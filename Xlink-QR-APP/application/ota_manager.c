@@ -6,25 +6,38 @@
 #include "ota_manager.h"
 #include "../common/qr_scanner.h"
 #include "../common/firmware_download.h"
+#include "../common/sha256.h"
 #include "../common/flash_manager.h"
 #include "../common/version_control.h"
 #include "../common/ui_status.h"
 #include "../drivers/stm32_hal_wrapper.h"
+#include "../config.h"
 #include <string.h>
 #include <stdlib.h>
 
+#if ENABLE_SIGNATURE_CHECK
+#include "../common/firmware_sign.h"
+#include "../common/signing_key.h"
+
+// 固件签名公钥（与Bootloader相同）
+static const uint8_t g_signing_key[ED25519_PUBLIC_KEY_SIZE] = FIRMWARE_SIGNING_KEY;
+#endif
+
 // OTA状态机
 static ota_state_t g_ota_state = OTA_STATE_IDLE;
 static ota_error_t g_ota_error = OTA_ERROR_NONE;
 
-// 固件缓冲区（需要根据实际RAM大小调整）
-#define FIRMWARE_BUFFER_SIZE     (28 * 1024)  // 28KB，匹配分区大小
-static uint8_t g_firmware_buffer[FIRMWARE_BUFFER_SIZE];
-
 // 固件信息
+// 固件不再缓存在RAM中，下载时按页流式写入目标分区
 static char g_firmware_url[QR_URL_MAX_LEN];
 static uint32_t g_firmware_size = 0;
+static uint32_t g_firmware_crc = 0;      // 写入时逐页累加的镜像CRC32
+static partition_t g_target_partition = PARTITION_NONE;
 static firmware_version_t g_target_version;
+static uint8_t g_expected_sha256[SHA256_DIGEST_SIZE];  // 二维码给出的镜像摘要
+
+// 空闲时预擦除非活动分区是否已完成
+static bool g_preerase_done = false;
 
 /**
  * @brief 初始化OTA管理器
@@ -35,6 +48,8 @@ void ota_manager_init(void)
     g_ota_error = OTA_ERROR_NONE;
     memset(g_firmware_url, 0, sizeof(g_firmware_url));
     g_firmware_size = 0;
+    g_firmware_crc = 0;
+    g_target_partition = PARTITION_NONE;
 }
 
 /**
@@ -76,6 +91,29 @@ static void download_status_callback(download_status_t status)
     }
 }
 
+/**
+ * @brief 空闲时预擦除非活动分区（每次调用最多擦除一页）
+ * @note 只在从有效分区启动后进行；有断点续传任务时分区内容需要保留
+ */
+static void ota_preerase_tick(void)
+{
+#if !FLASH_DIFF_WRITE && FLASH_ERASE_MODE == FLASH_ERASE_PREERASE
+    if (g_preerase_done) {
+        return;
+    }
+    
+    partition_t target = flash_get_target_partition();
+    if (flash_get_current_partition() == PARTITION_NONE ||
+        firmware_download_has_session(target) ||
+        flash_preerase_step(target) <= 0) {
+        g_preerase_done = true;
+        flash_wear_flush();
+    }
+#else
+    g_preerase_done = true;
+#endif
+}
+
 /**
  * @brief 步骤1：扫描二维码获取URL
  */
@@ -100,26 +138,56 @@ static int ota_step_scan_qr(void)
         return -1;
     }
     
+    // 摘要放在URL片段中（"#sha256=..."），取出后URL中不再包含片段
+    int has_sha256 = qr_extract_sha256(g_firmware_url, g_expected_sha256);
+#if ENABLE_SHA256_CHECK
+    if (has_sha256 != 0) {
+        g_ota_state = OTA_STATE_FAILED;
+        g_ota_error = OTA_ERROR_INVALID_URL;
+        ui_show_error(UI_ERROR_NETWORK_ERROR);
+        return -1;
+    }
+#else
+    (void)has_sha256;
+#endif
+    
     return 0;
 }
 
 /**
- * @brief 步骤2：下载固件
+ * @brief 步骤2：下载固件（直接流式写入目标分区）
  */
 static int ota_step_download(void)
 {
     ui_update_status(UI_STATUS_DOWNLOADING);
     g_ota_state = OTA_STATE_DOWNLOADING;
     
-    int ret = firmware_download_from_url(
+    // 下载数据按页直接写入目标分区（支持断点续传）
+    g_target_partition = flash_get_target_partition();
+    
+    // 目标分区即将被覆盖，先标记为无效（已是无效时不写入）
+    flash_mark_partition_invalid(g_target_partition);
+    
+    // 统计本次升级擦除、跳过、重写的页数
+    flash_reset_stats();
+    
+    int ret = firmware_download_to_partition(
         g_firmware_url,
-        g_firmware_buffer,
-        FIRMWARE_BUFFER_SIZE,
+        g_target_partition,
         &g_firmware_size,
+        &g_firmware_crc,
         download_progress_callback,
         download_status_callback
     );
     
+    if (ret != 0 && firmware_download_get_fail_addr() != 0) {
+        // 写入回读比较失败（Flash损坏或擦除不完整）
+        g_ota_state = OTA_STATE_FAILED;
+        g_ota_error = OTA_ERROR_FLASH_WRITE_FAILED;
+        ui_show_error(UI_ERROR_FLASH_WRITE_FAILED);
+        return -1;
+    }
+    
     if (ret != 0) {
         g_ota_state = OTA_STATE_FAILED;
         g_ota_error = OTA_ERROR_DOWNLOAD_FAILED;
@@ -127,7 +195,7 @@ static int ota_step_download(void)
         return -1;
     }
     
-    if (g_firmware_size == 0 || g_firmware_size > FIRMWARE_BUFFER_SIZE) {
+    if (g_firmware_size == 0 || g_firmware_size > PARTITION_SIZE - sizeof(partition_info_t)) {
         g_ota_state = OTA_STATE_FAILED;
         g_ota_error = OTA_ERROR_DOWNLOAD_FAILED;
         ui_show_error(UI_ERROR_DOWNLOAD_FAILED);
@@ -145,8 +213,11 @@ static int ota_step_verify(void)
     ui_update_status(UI_STATUS_VERIFYING);
     g_ota_state = OTA_STATE_VERIFYING;
     
+    // 固件已在目标分区中，直接从Flash读取
+    const uint8_t *firmware = (const uint8_t *)flash_get_partition_base(g_target_partition);
+    
     // 提取目标版本
-    if (version_extract_from_firmware(g_firmware_buffer, g_firmware_size, 
+    if (version_extract_from_firmware(firmware, g_firmware_size, 
                                       &g_target_version) != 0) {
         g_ota_state = OTA_STATE_FAILED;
         g_ota_error = OTA_ERROR_VERSION_CHECK_FAILED;
@@ -169,50 +240,51 @@ static int ota_step_verify(void)
     
     // CRC32校验（从固件头部读取期望的CRC32值）
     // 这里需要根据实际固件格式解析CRC32
-    // uint32_t expected_crc = extract_crc32_from_firmware(g_firmware_buffer);
-    // if (!firmware_verify_crc32(g_firmware_buffer, g_firmware_size, expected_crc)) {
+    // uint32_t expected_crc = extract_crc32_from_firmware(firmware);
+    // if (!firmware_verify_crc32(firmware, g_firmware_size, expected_crc)) {
     //     g_ota_state = OTA_STATE_FAILED;
     //     g_ota_error = OTA_ERROR_VERIFY_FAILED;
     //     ui_show_error(UI_ERROR_VERIFY_FAILED);
     //     return -1;
     // }
     
+#if ENABLE_SHA256_CHECK
+    // SHA-256校验：摘要在下载写入时逐页算好，与二维码给出的摘要比较
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    if (firmware_download_get_sha256(digest) != 0 ||
+        memcmp(digest, g_expected_sha256, SHA256_DIGEST_SIZE) != 0) {
+        g_ota_state = OTA_STATE_FAILED;
+        g_ota_error = OTA_ERROR_VERIFY_FAILED;
+        ui_show_error(UI_ERROR_VERIFY_FAILED);
+        return -1;
+    }
+#endif
+    
+#if ENABLE_SIGNATURE_CHECK
+    // 签名校验：未签名或签名无效的固件不写入分区信息，旧分区保持有效，
+    // 避免Bootloader启动时才发现
+    if (!firmware_verify_signature(g_target_partition, g_firmware_size, g_signing_key)) {
+        g_ota_state = OTA_STATE_FAILED;
+        g_ota_error = OTA_ERROR_VERIFY_FAILED;
+        ui_show_error(UI_ERROR_VERIFY_FAILED);
+        return -1;
+    }
+#endif
+    
     return 0;
 }
 
 /**
  * @brief 步骤4：写入Flash
+ * @note 固件数据已在下载时写入目标分区并逐页回读比较，CRC也在写入时算好，
+ *       这里只写入分区信息，不再读取整个分区校验
  */
 static int ota_step_write_flash(void)
 {
     ui_update_status(UI_STATUS_WRITING_FLASH);
     g_ota_state = OTA_STATE_WRITING;
     
-    // 获取目标分区
-    partition_t target_partition = flash_get_target_partition();
-    
-    // 标记当前分区为无效（防止启动失败时回滚到旧版本）
-    partition_t current_partition = flash_get_current_partition();
-    if (current_partition != PARTITION_NONE) {
-        flash_mark_partition_invalid(current_partition);
-    }
-    
-    // 擦除目标分区
-    if (flash_erase_partition(target_partition) != 0) {
-        g_ota_state = OTA_STATE_FAILED;
-        g_ota_error = OTA_ERROR_FLASH_ERASE_FAILED;
-        ui_show_error(UI_ERROR_FLASH_WRITE_FAILED);
-        return -1;
-    }
-    
-    // 写入固件数据
-    if (flash_write_partition(target_partition, 0, g_firmware_buffer, 
-                              g_firmware_size) != 0) {
-        g_ota_state = OTA_STATE_FAILED;
-        g_ota_error = OTA_ERROR_FLASH_WRITE_FAILED;
-        ui_show_error(UI_ERROR_FLASH_WRITE_FAILED);
-        return -1;
-    }
+    partition_t target_partition = g_target_partition;
     
     // 写入分区信息
     partition_info_t partition_info;
@@ -221,9 +293,12 @@ static int ota_step_write_flash(void)
                            g_target_version.minor << 16 |
                            g_target_version.revision << 8 |
                            g_target_version.build;
-    partition_info.crc32 = calculate_crc32(g_firmware_buffer, g_firmware_size);
+    partition_info.crc32 = g_firmware_crc;
     partition_info.size = g_firmware_size;
     partition_info.status = PARTITION_VALID;
+    // 填充区CRC用于深度校验（镜像之后的内容是旧数据或空白，这里读取一次）
+    partition_info.padding_crc32 = flash_partition_padding_crc(target_partition, g_firmware_size);
+    partition_info.padding_magic = PARTITION_PADDING_MAGIC;
     memset(partition_info.reserved, 0, sizeof(partition_info.reserved));
     
     if (flash_write_partition_info(target_partition, &partition_info) != 0) {
@@ -233,12 +308,11 @@ static int ota_step_write_flash(void)
         return -1;
     }
     
-    // 验证写入的数据
-    if (!flash_verify_partition(target_partition)) {
-        g_ota_state = OTA_STATE_FAILED;
-        g_ota_error = OTA_ERROR_VERIFY_FAILED;
-        ui_show_error(UI_ERROR_VERIFY_FAILED);
-        return -1;
+    // 新分区信息写入后再标记当前分区为无效（防止启动失败时回滚到旧版本），
+    // 两次追加之间掉电时两个分区都有效，不会没有可启动的分区
+    partition_t current_partition = flash_get_current_partition();
+    if (current_partition != PARTITION_NONE) {
+        flash_mark_partition_invalid(current_partition);
     }
     
     return 0;
@@ -266,6 +340,8 @@ void ota_process(void)
         case OTA_STATE_IDLE:
             if (ota_has_pending_upgrade()) {
                 g_ota_state = OTA_STATE_SCANNING;
+            } else {
+                ota_preerase_tick();
             }
             break;
             
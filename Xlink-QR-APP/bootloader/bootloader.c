@@ -8,6 +8,14 @@
 #include "../drivers/stm32_hal_wrapper.h"
 #include <string.h>
 
+#if BOOTLOADER_VERIFY_SIGNATURE
+#include "../common/firmware_sign.h"
+#include "../common/signing_key.h"
+
+// 固件签名公钥
+static const uint8_t g_signing_key[ED25519_PUBLIC_KEY_SIZE] = FIRMWARE_SIGNING_KEY;
+#endif
+
 // 向量表结构
 typedef struct {
     uint32_t stack_pointer;
@@ -56,6 +64,36 @@ bool bootloader_should_enter(void)
     return false;
 }
 
+/**
+ * @brief 按配置校验分区
+ * @note 启用签名验证时签名已覆盖整个固件，不再单独计算CRC（省去CRC代码和一遍读取）
+ */
+static bool bootloader_verify_partition(partition_t partition)
+{
+#if BOOTLOADER_VERIFY_DEEP
+    return flash_verify_partition_deep(partition);
+#elif BOOTLOADER_VERIFY_SIGNATURE
+    (void)partition;
+    return true;
+#else
+    return flash_verify_partition(partition);
+#endif
+}
+
+/**
+ * @brief 按配置验证分区签名
+ */
+static bool bootloader_verify_signature(partition_t partition, const partition_info_t *info)
+{
+#if BOOTLOADER_VERIFY_SIGNATURE
+    return firmware_verify_signature(partition, info->size, g_signing_key);
+#else
+    (void)partition;
+    (void)info;
+    return true;
+#endif
+}
+
 /**
  * @brief 验证分区并决定启动哪个分区
  */
@@ -68,7 +106,7 @@ partition_t bootloader_select_partition(void)
     if (flash_read_partition_info(PARTITION_A, &info_a) == 0) {
         if (info_a.magic == PARTITION_MAGIC && 
             info_a.status == PARTITION_VALID) {
-            valid_a = flash_verify_partition(PARTITION_A);
+            valid_a = bootloader_verify_partition(PARTITION_A);
         }
     }
     
@@ -76,7 +114,7 @@ partition_t bootloader_select_partition(void)
     if (flash_read_partition_info(PARTITION_B, &info_b) == 0) {
         if (info_b.magic == PARTITION_MAGIC && 
             info_b.status == PARTITION_VALID) {
-            valid_b = flash_verify_partition(PARTITION_B);
+            valid_b = bootloader_verify_partition(PARTITION_B);
         }
     }
     
@@ -85,17 +123,28 @@ partition_t bootloader_select_partition(void)
     // 2. 如果两个都有效，选择版本更高的
     // 3. 如果都无效，返回NONE
     
+    // 4. 签名较慢，只验证选中的分区，失败再验证另一个
+    
     if (valid_a && valid_b) {
-        // 两个都有效，选择版本更高的
-        if (info_a.version > info_b.version) {
-            return PARTITION_A;
-        } else {
-            return PARTITION_B;
+        // 两个都有效，优先版本更高的
+        bool prefer_a = info_a.version > info_b.version;
+        partition_t first = prefer_a ? PARTITION_A : PARTITION_B;
+        partition_t second = prefer_a ? PARTITION_B : PARTITION_A;
+        
+        if (bootloader_verify_signature(first, prefer_a ? &info_a : &info_b)) {
+            return first;
+        }
+        if (bootloader_verify_signature(second, prefer_a ? &info_b : &info_a)) {
+            return second;
         }
     } else if (valid_a) {
-        return PARTITION_A;
+        if (bootloader_verify_signature(PARTITION_A, &info_a)) {
+            return PARTITION_A;
+        }
     } else if (valid_b) {
-        return PARTITION_B;
+        if (bootloader_verify_signature(PARTITION_B, &info_b)) {
+            return PARTITION_B;
+        }
     }
     
     return PARTITION_NONE;
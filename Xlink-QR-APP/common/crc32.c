@@ -0,0 +1,180 @@
+/**
+ * @file crc32.c
+ * @brief CRC32计算实现
+ */
+
+#include "crc32.h"
+#include "../drivers/stm32_hal_wrapper.h"
+#include <stddef.h>
+#include <string.h>
+
+#if CRC32_HW && defined(__ARM_ARCH) && !defined(FLASH_SIM)
+#ifdef USE_HAL_DRIVER
+#include "stm32f1xx_hal.h"
+#else
+#include "stm32f10x.h"  // __RBIT（CMSIS）
+#endif
+#endif
+
+#if CRC32_TABLE != CRC32_TABLE_NIBBLE && CRC32_TABLE != CRC32_TABLE_BYTE && \
+    CRC32_TABLE != CRC32_TABLE_SLICE4 && CRC32_TABLE != CRC32_TABLE_SLICE8
+#error "CRC32_TABLE must be one of CRC32_TABLE_NIBBLE/BYTE/SLICE4/SLICE8"
+#endif
+
+// 短于此长度的数据不使用CRC单元（设置起始值和反转结果约需300个周期）
+#define CRC32_HW_MIN_SIZE   64
+
+// 查找表（构建时由scripts/gen_crc32_table.c生成到build/gen）
+#include "crc32_table.h"
+
+#if CRC32_HW
+/**
+ * @brief 按位反转（CRC单元的寄存器值是软件状态的位反转）
+ * @note 芯片上为一条RBIT指令（内联到RAM中执行的调用者），主机Flash模拟中逐位计算
+ */
+static inline uint32_t crc32_reflect(uint32_t value)
+{
+#if defined(__ARM_ARCH) && !defined(FLASH_SIM)
+    return __RBIT(value);
+#else
+    uint32_t result = 0;
+    for (int i = 0; i < 32; i++) {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+#endif
+}
+
+/**
+ * @brief CRC单元复位后写入哪个字能使CRC_DR等于指定值
+ * @note 写入一个字：DR = f(DR ^ word)，f为32次移位，可以逐位反推，
+ *       复位值为0xFFFFFFFF，所以word = 0xFFFFFFFF ^ f的逆(target)
+ */
+RAMFUNC static uint32_t crc32_hw_seed(uint32_t target)
+{
+    for (int i = 0; i < 32; i++) {
+        // 移位后最低位为0，为1说明移出的最高位是1并异或了多项式
+        target = (target & 1) ? ((target ^ 0x04C11DB7) >> 1) | 0x80000000 : target >> 1;
+    }
+    return target ^ 0xFFFFFFFF;
+}
+#endif
+
+/**
+ * @brief 逐字节处理（开头对齐部分、结尾和短数据）
+ */
+RAMFUNC static uint32_t crc32_bytes(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+#if CRC32_TABLE == CRC32_TABLE_NIBBLE
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc32_table_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_table_nibble[crc & 0x0F];
+#else
+        crc = (crc >> 8) ^ crc32_table[0][(crc ^ data[i]) & 0xFF];
+#endif
+    }
+    return crc;
+}
+
+/**
+ * @brief 开始计算CRC32
+ */
+uint32_t crc32_init(void)
+{
+    return 0xFFFFFFFF;
+}
+
+/**
+ * @brief 累加一段数据
+ * @note 在RAM中执行：72MHz下从Flash取指有2个等待周期，校验整个分区时差别明显。
+ *       按字读取用memcpy（Cortex-M3上编译为一条LDR），数据为小端
+ */
+RAMFUNC uint32_t crc32_update(uint32_t state, const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = state;
+    
+#if CRC32_TABLE >= CRC32_TABLE_SLICE4 || CRC32_HW
+    // 逐字节处理到4字节对齐
+    uint32_t head = (4 - ((uintptr_t)data & 3)) & 3;
+    if (head > size) {
+        head = size;
+    }
+    crc = crc32_bytes(crc, data, head);
+    data += head;
+    size -= head;
+#endif
+    
+#if CRC32_HW
+    if (size >= CRC32_HW_MIN_SIZE) {
+        uint32_t words = size / 4;
+        uint32_t dr = crc_unit_calc(crc32_hw_seed(crc32_reflect(crc)),
+                                    (const uint32_t *)data, words);
+        crc = crc32_reflect(dr);
+        data += words * 4;
+        size -= words * 4;
+    }
+#endif
+    
+#if CRC32_TABLE >= CRC32_TABLE_SLICE4
+#if CRC32_TABLE == CRC32_TABLE_SLICE8
+    while (size >= 8) {
+        uint32_t one;
+        uint32_t two;
+        memcpy(&one, data, 4);
+        memcpy(&two, data + 4, 4);
+        one ^= crc;
+        crc = crc32_table[7][one & 0xFF] ^
+              crc32_table[6][(one >> 8) & 0xFF] ^
+              crc32_table[5][(one >> 16) & 0xFF] ^
+              crc32_table[4][one >> 24] ^
+              crc32_table[3][two & 0xFF] ^
+              crc32_table[2][(two >> 8) & 0xFF] ^
+              crc32_table[1][(two >> 16) & 0xFF] ^
+              crc32_table[0][two >> 24];
+        data += 8;
+        size -= 8;
+    }
+#endif
+    
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, data, 4);
+        word ^= crc;
+        crc = crc32_table[3][word & 0xFF] ^
+              crc32_table[2][(word >> 8) & 0xFF] ^
+              crc32_table[1][(word >> 16) & 0xFF] ^
+              crc32_table[0][word >> 24];
+        data += 4;
+        size -= 4;
+    }
+#endif
+    
+    return crc32_bytes(crc, data, size);
+}
+
+/**
+ * @brief 结束计算
+ */
+uint32_t crc32_final(uint32_t state)
+{
+    return state ^ 0xFFFFFFFF;
+}
+
+/**
+ * @brief 计算CRC32校验值
+ */
+uint32_t calculate_crc32(const uint8_t *data, uint32_t size)
+{
+    return crc32_final(crc32_update(crc32_init(), data, size));
+}
+
+/**
+ * @brief 在已有CRC32的基础上继续计算
+ */
+uint32_t calculate_crc32_update(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    // 结束值取反即为中间状态
+    return crc32_final(crc32_update(crc ^ 0xFFFFFFFF, data, size));
+}
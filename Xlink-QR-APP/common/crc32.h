@@ -0,0 +1,86 @@
+/**
+ * @file crc32.h
+ * @brief CRC32计算（IEEE 802.3，与zlib的crc32()结果相同）
+ * @note 增量接口：state = crc32_init()，多次crc32_update()，最后crc32_final()。
+ *       查找表方案由CRC32_TABLE选择，表在构建时生成（scripts/gen_crc32_table.c）。
+ *       slicing方案数据按4字节对齐后每次处理一个字（SLICE4）或两个字（SLICE8），
+ *       开头和结尾不足一个字的部分逐字节处理。
+ *       启用CRC32_HW时对齐的字由CRC单元计算：CRC单元是不反射的CRC-32/MPEG-2，
+ *       每个字按位反转后写入，结果再按位反转，与软件计算结果完全相同。
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+// 使用CRC单元（主机Flash模拟中为寄存器模型）
+#ifndef CRC32_HW
+#if defined(__arm__) || defined(FLASH_SIM)
+#define CRC32_HW      1
+#else
+#define CRC32_HW      0
+#endif
+#endif
+
+// 查找表方案（Flash占用 / Cortex-M3 72MHz速度）。周期数是按每字节的指令数和Flash
+// 等待周期估算的（代码在RAM、表在Flash），没有在芯片上实测；主机上各方案的实测
+// 速度见tests/test_crc32.c的test_throughput（make test输出）
+#define CRC32_TABLE_NIBBLE   0    // 16项半字节表：64字节 / 估计约20周期每字节
+#define CRC32_TABLE_BYTE     1    // 256项字节表：1KB / 估计约10周期每字节
+#define CRC32_TABLE_SLICE4   4    // slicing-by-4：4KB / 估计约5周期每字节
+#define CRC32_TABLE_SLICE8   8    // slicing-by-8：8KB，Cortex-M3上寄存器不够，只用于主机
+// 启用CRC32_HW时对齐的数据估计约2周期每字节，查找表只处理短数据和首尾字节
+
+// 默认：使用CRC单元时用字节表，否则芯片上用SLICE4、主机上用SLICE8
+// （Makefile为Bootloader指定BOOTLOADER_CRC32_TABLE）
+#ifndef CRC32_TABLE
+#if CRC32_HW
+#define CRC32_TABLE   CRC32_TABLE_BYTE
+#elif defined(__arm__)
+#define CRC32_TABLE   CRC32_TABLE_SLICE4
+#else
+#define CRC32_TABLE   CRC32_TABLE_SLICE8
+#endif
+#endif
+
+/**
+ * @brief 开始计算CRC32
+ * @return 初始状态
+ */
+uint32_t crc32_init(void);
+
+/**
+ * @brief 累加一段数据
+ * @param state 当前状态（crc32_init()或上一次crc32_update()的返回值）
+ * @param data 数据指针（任意对齐）
+ * @param size 数据大小
+ * @return 新的状态
+ */
+uint32_t crc32_update(uint32_t state, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 结束计算
+ * @param state 当前状态
+ * @return CRC32值
+ */
+uint32_t crc32_final(uint32_t state);
+
+/**
+ * @brief 计算CRC32校验值
+ * @param data 数据指针
+ * @param size 数据大小
+ * @return CRC32值
+ */
+uint32_t calculate_crc32(const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 在已有CRC32的基础上继续计算（分段计算与整体计算结果相同）
+ * @param crc 前面数据的CRC32（第一段传0）
+ * @param data 数据指针
+ * @param size 数据大小
+ * @return 包含本段数据的CRC32值
+ */
+uint32_t calculate_crc32_update(uint32_t crc, const uint8_t *data, uint32_t size);
+
+#endif // CRC32_H
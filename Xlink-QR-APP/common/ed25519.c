@@ -0,0 +1,481 @@
+/**
+ * @file ed25519.c
+ * @brief Ed25519签名验证实现
+ * @note 域元素为GF(2^255-19)，16个16位limb（小端），运算结果不完全约简，
+ *       只在打包（比较、取奇偶）时约简。点使用扩展坐标(X, Y, Z, T)，
+ *       加法公式对相同点也成立，倍点直接用加法。
+ */
+
+#include "ed25519.h"
+#include <stdbool.h>
+#include <string.h>
+
+typedef int32_t gf[16];
+
+// 加减、赋值等小函数调用处很多，内联后代码明显变大（Bootloader只有6KB），不内联
+#define FE_NOINLINE   __attribute__((noinline))
+
+// 曲线参数d、2d，基点B的坐标，sqrt(-1)（每个limb 16位，用时fe_load展开，节省Flash）
+static const uint16_t ed_d[16] = {
+    0x78A3, 0x1359, 0x4DCA, 0x75EB, 0xD8AB, 0x4141, 0x0A4D, 0x0070,
+    0xE898, 0x7779, 0x4079, 0x8CC7, 0xFE73, 0x2B6F, 0x6CEE, 0x5203
+};
+static const uint16_t ed_d2[16] = {
+    0xF159, 0x26B2, 0x9B94, 0xEBD6, 0xB156, 0x8283, 0x149A, 0x00E0,
+    0xD130, 0xEEF3, 0x80F2, 0x198E, 0xFCE7, 0x56DF, 0xD9DC, 0x2406
+};
+static const uint16_t ed_bx[16] = {
+    0xD51A, 0x8F25, 0x2D60, 0xC956, 0xA7B2, 0x9525, 0xC760, 0x692C,
+    0xDC5C, 0xFDD6, 0xE231, 0xC0A4, 0x53FE, 0xCD6E, 0x36D3, 0x2169
+};
+static const uint16_t ed_by[16] = {
+    0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+    0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666
+};
+static const uint16_t ed_sqrtm1[16] = {
+    0xA0B0, 0x4A0E, 0x1B27, 0xC4EE, 0xE478, 0xAD2F, 0x1806, 0x2F43,
+    0xD7A7, 0x3DFB, 0x0099, 0x2B4D, 0xDF0B, 0x4FC1, 0x2480, 0x2B83
+};
+
+// 群的阶L（小端字节）
+static const uint8_t ed_order[32] = {
+    0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2, 0xDE, 0xF9, 0xDE, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+// ==================== 域运算 ====================
+
+/**
+ * @brief 进位：每个limb保留低16位，最高limb的进位乘38加到最低limb（2^256 = 38）
+ */
+static void fe_carry(int64_t *o)
+{
+    for (int i = 0; i < 16; i++) {
+        int64_t c = o[i] >> 16;
+        o[i] &= 0xFFFF;
+        if (i < 15) {
+            o[i + 1] += c;
+        } else {
+            o[0] += 38 * c;
+        }
+    }
+}
+
+static void fe_copy(gf o, const gf a)
+{
+    memcpy(o, a, sizeof(gf));
+}
+
+FE_NOINLINE static void fe_set(gf o, int32_t v)
+{
+    memset(o, 0, sizeof(gf));
+    o[0] = v;
+}
+
+FE_NOINLINE static void fe_load(gf o, const uint16_t *c)
+{
+    for (int i = 0; i < 16; i++) {
+        o[i] = c[i];
+    }
+}
+
+FE_NOINLINE static void fe_add(gf o, const gf a, const gf b)
+{
+    for (int i = 0; i < 16; i++) {
+        o[i] = a[i] + b[i];
+    }
+}
+
+FE_NOINLINE static void fe_sub(gf o, const gf a, const gf b)
+{
+    for (int i = 0; i < 16; i++) {
+        o[i] = a[i] - b[i];
+    }
+}
+
+/**
+ * @brief 乘法（o可以与a、b相同）
+ * @note 按列累加：第k列的乘积和在寄存器中累加（SMLAL），每列只写一次内存；
+ *       2^256以上的部分（i + j >= 16）乘38折回第k列
+ */
+static void fe_mul(gf o, const gf a, const gf b)
+{
+    int64_t t[16];
+    
+    for (int k = 0; k < 16; k++) {
+        int64_t lo = 0;
+        int64_t hi = 0;
+        int i;
+        
+        for (i = 0; i <= k; i++) {
+            lo += (int64_t)a[i] * b[k - i];
+        }
+        for (; i < 16; i++) {
+            hi += (int64_t)a[i] * b[k + 16 - i];
+        }
+        t[k] = lo + 38 * hi;
+    }
+    fe_carry(t);
+    fe_carry(t);
+    
+    for (int i = 0; i < 16; i++) {
+        o[i] = (int32_t)t[i];
+    }
+}
+
+static void fe_sq(gf o, const gf a)
+{
+    fe_mul(o, a, a);
+}
+
+/**
+ * @brief 完全约简后按小端输出32字节
+ */
+static void fe_pack(uint8_t *o, const gf n)
+{
+    gf t;
+    gf m;
+    
+    // 输入来自乘法或少量加减，limb不超过2^20，进位用32位即可
+    fe_copy(t, n);
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 16; i++) {
+            int32_t c = t[i] >> 16;
+            t[i] &= 0xFFFF;
+            if (i < 15) {
+                t[i + 1] += c;
+            } else {
+                t[0] += 38 * c;
+            }
+        }
+    }
+    
+    // 两次减去p，结果为负时保留原值
+    for (int j = 0; j < 2; j++) {
+        m[0] = t[0] - 0xFFED;
+        for (int i = 1; i < 15; i++) {
+            m[i] = t[i] - 0xFFFF - ((m[i - 1] >> 16) & 1);
+            m[i - 1] &= 0xFFFF;
+        }
+        m[15] = t[15] - 0x7FFF - ((m[14] >> 16) & 1);
+        m[14] &= 0xFFFF;
+        if (((m[15] >> 16) & 1) == 0) {
+            memcpy(t, m, sizeof(t));
+        }
+    }
+    
+    for (int i = 0; i < 16; i++) {
+        o[2 * i] = (uint8_t)t[i];
+        o[2 * i + 1] = (uint8_t)(t[i] >> 8);
+    }
+}
+
+static void fe_unpack(gf o, const uint8_t *n)
+{
+    for (int i = 0; i < 16; i++) {
+        o[i] = n[2 * i] | ((int32_t)n[2 * i + 1] << 8);
+    }
+    o[15] &= 0x7FFF;
+}
+
+/**
+ * @brief 两个元素是否相等
+ */
+static bool fe_equal(const gf a, const gf b)
+{
+    uint8_t pa[32];
+    uint8_t pb[32];
+    
+    fe_pack(pa, a);
+    fe_pack(pb, b);
+    return memcmp(pa, pb, 32) == 0;
+}
+
+/**
+ * @brief 奇偶（约简后的最低位）
+ */
+static uint8_t fe_parity(const gf a)
+{
+    uint8_t d[32];
+    
+    fe_pack(d, a);
+    return d[0] & 1;
+}
+
+/**
+ * @brief 幂运算：指数最高位到第0位全为1，只有zero_bits（低32位内）中的位为0
+ * @param top 最高位以下的位数
+ * @note 求逆a^(p-2)：top = 253，第2、4位为0；
+ *       开平方用的a^((p-5)/8)：top = 250，第1位为0
+ */
+static void fe_pow(gf o, const gf a, int top, uint32_t zero_bits)
+{
+    gf c;
+    
+    fe_copy(c, a);
+    for (int i = top; i >= 0; i--) {
+        fe_sq(c, c);
+        if (i >= 32 || ((zero_bits >> i) & 1) == 0) {
+            fe_mul(c, c, a);
+        }
+    }
+    fe_copy(o, c);
+}
+
+static void fe_invert(gf o, const gf a)
+{
+    fe_pow(o, a, 253, (1u << 2) | (1u << 4));
+}
+
+static void fe_pow2523(gf o, const gf a)
+{
+    fe_pow(o, a, 250, 1u << 1);
+}
+
+// ==================== 点运算 ====================
+
+/**
+ * @brief p = p + q（扩展坐标，公式对p == q也成立）
+ */
+static void ge_add(gf p[4], const gf q[4])
+{
+    gf a, b, c, d, t, e, f, g, h;
+    
+    fe_load(t, ed_d2);
+    fe_mul(c, p[3], q[3]);
+    fe_mul(c, c, t);
+    fe_sub(a, p[1], p[0]);
+    fe_sub(t, q[1], q[0]);
+    fe_mul(a, a, t);
+    fe_add(b, p[0], p[1]);
+    fe_add(t, q[0], q[1]);
+    fe_mul(b, b, t);
+    fe_mul(d, p[2], q[2]);
+    fe_add(d, d, d);
+    fe_sub(e, b, a);
+    fe_sub(f, d, c);
+    fe_add(g, d, c);
+    fe_add(h, b, a);
+    
+    fe_mul(p[0], e, f);
+    fe_mul(p[1], h, g);
+    fe_mul(p[2], g, f);
+    fe_mul(p[3], e, h);
+}
+
+/**
+ * @brief 点编码：y坐标，最高位为x的奇偶
+ */
+static void ge_pack(uint8_t *r, const gf p[4])
+{
+    gf zi, tx, ty;
+    
+    fe_invert(zi, p[2]);
+    fe_mul(tx, p[0], zi);
+    fe_mul(ty, p[1], zi);
+    fe_pack(r, ty);
+    r[31] ^= fe_parity(tx) << 7;
+}
+
+/**
+ * @brief 解码公钥并取负（得到-A）
+ * @return 0成功，-1不是曲线上的点
+ */
+static int ge_unpack_negate(gf r[4], const uint8_t *p)
+{
+    gf t, chk, num, den, den2, den4, den6;
+    
+    fe_set(r[2], 1);
+    fe_unpack(r[1], p);
+    
+    // x^2 = (y^2 - 1) / (d * y^2 + 1)
+    fe_load(t, ed_d);
+    fe_sq(num, r[1]);
+    fe_mul(den, num, t);
+    fe_sub(num, num, r[2]);
+    fe_add(den, r[2], den);
+    
+    // x = num * den^3 * (num * den^7)^((p-5)/8)
+    fe_sq(den2, den);
+    fe_sq(den4, den2);
+    fe_mul(den6, den4, den2);
+    fe_mul(t, den6, num);
+    fe_mul(t, t, den);
+    fe_pow2523(t, t);
+    fe_mul(t, t, num);
+    fe_mul(t, t, den);
+    fe_mul(t, t, den);
+    fe_mul(r[0], t, den);
+    
+    fe_sq(chk, r[0]);
+    fe_mul(chk, chk, den);
+    if (!fe_equal(chk, num)) {
+        fe_load(t, ed_sqrtm1);
+        fe_mul(r[0], r[0], t);
+    }
+    
+    fe_sq(chk, r[0]);
+    fe_mul(chk, chk, den);
+    if (!fe_equal(chk, num)) {
+        return -1;
+    }
+    
+    // 取与编码相反的x
+    if (fe_parity(r[0]) == (p[31] >> 7)) {
+        fe_set(t, 0);
+        fe_sub(r[0], t, r[0]);
+    }
+    
+    fe_mul(r[3], r[0], r[1]);
+    return 0;
+}
+
+// ==================== 标量 ====================
+
+/**
+ * @brief 64字节小端整数模L
+ * @note 每个元素是一个字节加上少量进位，16 * x[i] * L[j]约为2^20，32位足够
+ */
+static void sc_reduce(uint8_t *r, const uint8_t *in)
+{
+    int32_t x[64];
+    int32_t carry;
+    int i;
+    int j;
+    
+    for (i = 0; i < 64; i++) {
+        x[i] = in[i];
+    }
+    
+    for (i = 63; i >= 32; i--) {
+        carry = 0;
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * ed_order[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    
+    carry = 0;
+    for (j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * ed_order[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (j = 0; j < 32; j++) {
+        x[j] -= carry * ed_order[j];
+    }
+    for (i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+/**
+ * @brief 标量是否小于L（RFC 8032要求拒绝S >= L的签名）
+ */
+static bool sc_is_canonical(const uint8_t *s)
+{
+    for (int i = 31; i >= 0; i--) {
+        if (s[i] != ed_order[i]) {
+            return s[i] < ed_order[i];
+        }
+    }
+    return false;
+}
+
+// ==================== 签名验证 ====================
+
+/**
+ * @brief 开始验证
+ */
+void ed25519_verify_init(ed25519_verify_ctx_t *ctx, const uint8_t *signature,
+                         const uint8_t *public_key)
+{
+    memcpy(ctx->signature, signature, ED25519_SIGNATURE_SIZE);
+    memcpy(ctx->public_key, public_key, ED25519_PUBLIC_KEY_SIZE);
+    
+    // k = SHA-512(R || A || M)
+    sha512_init(&ctx->sha);
+    sha512_update(&ctx->sha, ctx->signature, 32);
+    sha512_update(&ctx->sha, ctx->public_key, ED25519_PUBLIC_KEY_SIZE);
+}
+
+/**
+ * @brief 输入一段消息
+ */
+void ed25519_verify_update(ed25519_verify_ctx_t *ctx, const uint8_t *data, uint32_t size)
+{
+    sha512_update(&ctx->sha, data, size);
+}
+
+/**
+ * @brief 结束验证：检查 S*B - k*A == R
+ * @note S和k同时处理（Shamir方法）：一条倍点链，每位最多一次加法，
+ *       两位都为1时加预先算好的B - A
+ */
+int ed25519_verify_final(ed25519_verify_ctx_t *ctx)
+{
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    uint8_t k[32];
+    uint8_t check[32];
+    gf neg_a[4];
+    gf base[4];
+    gf both[4];
+    gf p[4];
+    
+    sha512_final(&ctx->sha, digest);
+    
+    const uint8_t *s = ctx->signature + 32;
+    if (!sc_is_canonical(s) || ge_unpack_negate(neg_a, ctx->public_key) != 0) {
+        return -1;
+    }
+    sc_reduce(k, digest);
+    
+    fe_load(base[0], ed_bx);
+    fe_load(base[1], ed_by);
+    fe_set(base[2], 1);
+    fe_mul(base[3], base[0], base[1]);
+    
+    memcpy(both, base, sizeof(both));
+    ge_add(both, (const gf *)neg_a);
+    
+    // p = 中性元(0, 1, 1, 0)
+    fe_set(p[0], 0);
+    fe_set(p[1], 1);
+    fe_set(p[2], 1);
+    fe_set(p[3], 0);
+    
+    // S < L < 2^253，k < L
+    for (int i = 252; i >= 0; i--) {
+        ge_add(p, (const gf *)p);
+        
+        uint8_t bit_s = (s[i >> 3] >> (i & 7)) & 1;
+        uint8_t bit_k = (k[i >> 3] >> (i & 7)) & 1;
+        if (bit_s && bit_k) {
+            ge_add(p, (const gf *)both);
+        } else if (bit_s) {
+            ge_add(p, (const gf *)base);
+        } else if (bit_k) {
+            ge_add(p, (const gf *)neg_a);
+        }
+    }
+    
+    ge_pack(check, (const gf *)p);
+    return (memcmp(check, ctx->signature, 32) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief 验证一段消息的签名
+ */
+int ed25519_verify(const uint8_t *signature, const uint8_t *public_key,
+                   const uint8_t *message, uint32_t size)
+{
+    ed25519_verify_ctx_t ctx;
+    
+    ed25519_verify_init(&ctx, signature, public_key);
+    ed25519_verify_update(&ctx, message, size);
+    return ed25519_verify_final(&ctx);
+}
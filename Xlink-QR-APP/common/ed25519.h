@@ -0,0 +1,64 @@
+/**
+ * @file ed25519.h
+ * @brief Ed25519签名验证（RFC 8032，只验证不签名）
+ * @note 流式接口：ed25519_verify_init()输入签名和公钥，ed25519_verify_update()
+ *       分段输入消息（可直接指向Flash，不复制到RAM），ed25519_verify_final()
+ *       得到结果。消息只经过SHA-512一次，耗时与消息长度成正比，
+ *       另外固定约一次双标量乘法。
+ *       域运算以16位为一个limb（TweetNaCl的表示），乘法用32×32→64位累加，
+ *       Cortex-M3上为SMLAL指令；验证只处理公开数据，不要求恒定时间。
+ *       栈占用约1.5KB，不使用堆。
+ */
+
+#ifndef ED25519_H
+#define ED25519_H
+
+#include <stdint.h>
+#include "sha512.h"
+
+#define ED25519_PUBLIC_KEY_SIZE   32
+#define ED25519_SIGNATURE_SIZE    64
+
+// 验证上下文
+typedef struct {
+    sha512_ctx_t sha;                                // SHA-512(R || A || M)
+    uint8_t signature[ED25519_SIGNATURE_SIZE];       // R || S
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE];     // A
+} ed25519_verify_ctx_t;
+
+/**
+ * @brief 开始验证
+ * @param ctx 上下文
+ * @param signature 签名（64字节）
+ * @param public_key 公钥（32字节）
+ */
+void ed25519_verify_init(ed25519_verify_ctx_t *ctx, const uint8_t *signature,
+                         const uint8_t *public_key);
+
+/**
+ * @brief 输入一段消息
+ * @param ctx 上下文
+ * @param data 数据指针
+ * @param size 数据大小
+ */
+void ed25519_verify_update(ed25519_verify_ctx_t *ctx, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 结束验证
+ * @param ctx 上下文
+ * @return 0签名有效，-1无效
+ */
+int ed25519_verify_final(ed25519_verify_ctx_t *ctx);
+
+/**
+ * @brief 验证一段消息的签名
+ * @param signature 签名（64字节）
+ * @param public_key 公钥（32字节）
+ * @param message 消息
+ * @param size 消息大小
+ * @return 0签名有效，-1无效
+ */
+int ed25519_verify(const uint8_t *signature, const uint8_t *public_key,
+                   const uint8_t *message, uint32_t size);
+
+#endif // ED25519_H
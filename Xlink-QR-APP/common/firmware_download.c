@@ -4,56 +4,76 @@
  */
 
 #include "firmware_download.h"
+#include "meta_store.h"
+#include "sha256.h"
+#include "../config.h"
 #include "../drivers/http_client.h"
 #include "../drivers/stm32_hal_wrapper.h"
 #include <string.h>
 
-// CRC32查找表（IEEE 802.3标准）
-static const uint32_t crc32_table[256] = {
-    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
-    0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
-    0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
-    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
-    0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
-    0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
-    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
-    0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
-    0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
-    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
-    0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
-    0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
-    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
-    0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
-    0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
-    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
-    0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
-    0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
-    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
-    0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
-    0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
-    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
-    0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
-    0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
-    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
-    0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
-    0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
-    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
-    0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
-    0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
-    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
-    0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
-};
-
 static void *g_network_handle = NULL;
 
+// 流式写入的最大固件大小（分区末尾保留分区信息）
+#define STREAM_MAX_SIZE  (PARTITION_SIZE - sizeof(partition_info_t))
+
+// 流式写入页缓冲区（编程是同步的，写入期间不接收数据，一页即可）
+static uint8_t g_page_buffer[FLASH_PAGE_SIZE];
+
+// 断点续传任务信息（持久化在系统数据区，掉电重启后仍可续传）
+typedef struct {
+    uint32_t url_crc;                    // 下载URL的CRC32
+    uint32_t partition;                  // 目标分区
+    uint32_t total_size;                 // 固件总大小（未知为0）
+    char etag[HTTP_ETAG_MAX_LEN];        // 用于If-Range校验的强ETag
+} download_session_t;
+
+static download_session_t g_session;
+
+// 断点进度（每写完DOWNLOAD_PROGRESS_PAGES页追加一条记录）
+// 只记录续传位置，CRC和SHA-256续传时从Flash中已写入的数据重新计算，
+// 记录越短，系统数据区整理越少
+typedef struct {
+    uint32_t committed;          // 已提交到Flash的字节数（整页）
+} download_progress_t;
+
+// 流式写入上下文
+typedef struct {
+    partition_t partition;       // 目标分区
+    uint32_t flash_offset;       // 已写入Flash的字节数
+    uint32_t crc32;              // 已写入数据的CRC32（逐页累加）
+    sha256_ctx_t sha256;         // 已写入数据的SHA-256（逐页累加）
+    uint32_t fill;               // 当前接收页已填充字节数
+    bool resumable;              // 已记录断点，可用Range续传
+    bool flash_failed;           // Flash写入校验失败（不再重试）
+    download_progress_cb progress_cb;
+} firmware_stream_t;
+
+// 最近一次写入校验失败的Flash地址（0表示没有）
+static uint32_t g_fail_addr = 0;
+
+// 最近一次成功下载的镜像SHA-256
+static uint8_t g_image_sha256[SHA256_DIGEST_SIZE];
+static bool g_image_sha256_valid = false;
+
 /**
  * @brief 初始化固件下载模块
  */
 void firmware_download_init(void *network_handle)
 {
     g_network_handle = network_handle;
-    // 初始化HTTP客户端（使用AT命令模式，UART1）
-    http_client_init(HTTP_MODE_AT_COMMAND, 1);
+    
+    // 上次协商成功的波特率，模块未断电时直接使用
+    uint32_t cached = 0;
+    if (meta_store_read(META_TAG_WIFI_BAUDRATE, &cached, sizeof(cached)) != sizeof(cached)) {
+        cached = 0;
+    }
+    
+    // 初始化HTTP客户端（AT命令模式或透传模式，WiFi模块UART）
+    uint32_t baudrate = cached;
+    if (http_client_init(HTTP_DOWNLOAD_MODE, WIFI_UART_NUM, &baudrate) == 0 &&
+        baudrate != cached) {
+        meta_store_write(META_TAG_WIFI_BAUDRATE, &baudrate, sizeof(baudrate));
+    }
 }
 
 /**
@@ -97,54 +117,371 @@ int firmware_download_from_url(const char *url,
 }
 
 /**
- * @brief 计算CRC32校验值
+ * @brief 准备从offset开始重新写入分区
+ * @note 差分写入在每页写入时自行决定是否擦除，边下载边擦除在每页编程前擦除，
+ *       只有预擦除模式需要在这里擦除（预擦除过的页是空白，会被跳过）
+ */
+static int stream_prepare(partition_t partition, uint32_t offset)
+{
+#if !FLASH_DIFF_WRITE && FLASH_ERASE_MODE == FLASH_ERASE_PREERASE
+    return (flash_erase_partition_range(partition, offset, PARTITION_SIZE - offset) < 0) ? -1 : 0;
+#else
+    (void)partition;
+    (void)offset;
+    return 0;
+#endif
+}
+
+/**
+ * @brief 把已满的页写入Flash
+ * @note 写入时逐半字回读比较，发现不符立即返回失败地址；比较通过后该页数据
+ *       计入CRC和SHA-256，下载结束时即得到整个镜像的CRC和摘要，不需要再读一遍Flash。
  */
-uint32_t calculate_crc32(const uint8_t *data, uint32_t size)
+static int stream_flush_page(firmware_stream_t *stream)
 {
-    uint32_t crc = 0xFFFFFFFF;
+    const uint8_t *page = g_page_buffer;
+    uint32_t len = stream->fill;
     
-    for (uint32_t i = 0; i < size; i++) {
-        uint8_t index = (uint8_t)((crc ^ data[i]) & 0xFF);
-        crc = (crc >> 8) ^ crc32_table[index];
+    stream->fill = 0;
+    
+    uint32_t fail_addr = 0;
+#if FLASH_DIFF_WRITE
+    int ret = flash_write_partition_diff(stream->partition, stream->flash_offset, page, len, &fail_addr);
+#else
+#if FLASH_ERASE_MODE == FLASH_ERASE_JIT
+    // 边下载边擦除：编程前擦除该页（已是空白则跳过）
+    if (flash_erase_partition_range(stream->partition, stream->flash_offset, FLASH_PAGE_SIZE) < 0) {
+        fail_addr = flash_get_partition_base(stream->partition) + stream->flash_offset;
+    }
+#endif
+    int ret = (fail_addr != 0) ? -1 :
+              flash_write_partition(stream->partition, stream->flash_offset, page, len, &fail_addr);
+#endif
+    if (ret != 0) {
+        stream->flash_failed = true;
+        g_fail_addr = fail_addr;
+        return -1;
+    }
+    
+    stream->flash_offset += len;
+    stream->crc32 = calculate_crc32_update(stream->crc32, page, len);
+    sha256_update(&stream->sha256, page, len);
+    
+    // 记录断点：之前的页都已完整写入Flash（掉电最多重新下载DOWNLOAD_PROGRESS_PAGES页）
+    if (stream->resumable &&
+        stream->flash_offset % (DOWNLOAD_PROGRESS_PAGES * FLASH_PAGE_SIZE) == 0) {
+        download_progress_t progress;
+        progress.committed = stream->flash_offset;
+        meta_store_write(META_TAG_OTA_PROGRESS, &progress, sizeof(progress));
     }
     
-    return crc ^ 0xFFFFFFFF;
+    if (stream->progress_cb && g_session.total_size > 0) {
+        stream->progress_cb(stream->flash_offset, g_session.total_size);
+    }
+    
+    return 0;
 }
 
 /**
- * @brief 验证固件CRC32
+ * @brief HTTP响应头回调：确认续传或从头开始
  */
-bool firmware_verify_crc32(const uint8_t *data, uint32_t size, uint32_t expected_crc)
+static int stream_header_callback(const http_response_t *resp, void *ctx)
 {
-    uint32_t calculated_crc = calculate_crc32(data, size);
-    return (calculated_crc == expected_crc);
+    firmware_stream_t *stream = (firmware_stream_t *)ctx;
+    
+    if (stream->flash_offset > 0 && resp->status_code == 206) {
+        // ETag未变化，服务器从断点继续发送
+        if (!resp->has_content_range || resp->range_start != stream->flash_offset) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    if (resp->status_code == 206) {
+        return -1;  // 未请求范围却收到部分内容
+    }
+    
+    // 完整内容：资源已变化或服务器不支持Range，从头开始
+    if (stream->flash_offset > 0) {
+        stream->flash_offset = 0;
+        stream->crc32 = 0;
+        sha256_init(&stream->sha256);
+        if (stream_prepare(stream->partition, 0) != 0) {
+            return -1;
+        }
+    }
+    
+    g_session.total_size = (resp->has_content_length && !resp->chunked) ?
+                           resp->content_length : 0;
+    if (g_session.total_size > STREAM_MAX_SIZE) {
+        return -1;  // 超出分区容量
+    }
+    
+    // 先删除旧断点再记录新任务，掉电时不会把旧断点用于新任务
+    meta_store_delete(META_TAG_OTA_PROGRESS);
+    
+    // 只有强ETag（不以W/开头）才能用于If-Range
+    stream->resumable = (resp->etag[0] == '"');
+    if (stream->resumable) {
+        strcpy(g_session.etag, resp->etag);
+        meta_store_write(META_TAG_OTA_SESSION, &g_session, sizeof(g_session));
+    } else {
+        g_session.etag[0] = '\0';
+        meta_store_delete(META_TAG_OTA_SESSION);
+    }
+    
+    return 0;
 }
 
 /**
- * @brief 计算MD5哈希值
+ * @brief HTTP数据回调：按页组装并写入Flash
  */
-int calculate_md5(const uint8_t *data, uint32_t size, uint8_t *hash_output)
+static int stream_data_callback(const uint8_t *data, uint32_t len, void *ctx)
 {
-    // 需要实现MD5算法或使用外部库
-    // 这里提供接口，实际实现需要MD5算法
-    // 可以使用mbedTLS、wolfSSL等库
+    firmware_stream_t *stream = (firmware_stream_t *)ctx;
+    
+    if (stream->flash_offset + stream->fill + len > STREAM_MAX_SIZE) {
+        return -1;  // 超出分区容量
+    }
+    
+    while (len > 0) {
+        uint32_t space = FLASH_PAGE_SIZE - stream->fill;
+        uint32_t n = (len < space) ? len : space;
+        
+        memcpy(&g_page_buffer[stream->fill], data, n);
+        stream->fill += n;
+        data += n;
+        len -= n;
+        
+        if (stream->fill == FLASH_PAGE_SIZE) {
+            if (stream_flush_page(stream) != 0) {
+                return -1;
+            }
+        }
+    }
     
-    // 临时返回
-    memset(hash_output, 0, 16);
     return 0;
 }
 
 /**
- * @brief 验证固件MD5哈希
+ * @brief 恢复上次未完成的下载任务
+ * @param progress 断点进度（输出）
+ * @return true有可续传的任务
  */
-bool firmware_verify_md5(const uint8_t *data, uint32_t size, const uint8_t *expected_hash)
+static bool stream_load_session(const char *url, partition_t partition,
+                                download_progress_t *progress)
 {
-    uint8_t calculated_hash[16];
+    if (meta_store_read(META_TAG_OTA_SESSION, &g_session, sizeof(g_session)) != sizeof(g_session) ||
+        meta_store_read(META_TAG_OTA_PROGRESS, progress, sizeof(*progress)) != sizeof(*progress)) {
+        return false;
+    }
     
-    if (calculate_md5(data, size, calculated_hash) != 0) {
+    if (g_session.url_crc != calculate_crc32((const uint8_t *)url, strlen(url)) ||
+        g_session.partition != (uint32_t)partition ||
+        g_session.etag[0] != '"' ||
+        progress->committed == 0 ||
+        progress->committed % FLASH_PAGE_SIZE != 0 ||
+        progress->committed >= STREAM_MAX_SIZE) {
         return false;
     }
     
-    return (memcmp(calculated_hash, expected_hash, 16) == 0);
+    return true;
 }
 
+/**
+ * @brief 指定分区是否有未完成的断点续传任务
+ */
+bool firmware_download_has_session(partition_t partition)
+{
+    download_session_t session;
+    download_progress_t progress;
+    
+    return meta_store_read(META_TAG_OTA_SESSION, &session, sizeof(session)) == sizeof(session) &&
+           meta_store_read(META_TAG_OTA_PROGRESS, &progress, sizeof(progress)) == sizeof(progress) &&
+           session.partition == (uint32_t)partition && progress.committed > 0;
+}
+
+/**
+ * @brief 续传前从Flash读取断点之前的数据，恢复CRC32和SHA-256
+ * @note 28KB约需30ms（Cortex-M3 72MHz），只在每次下载开始时执行一次
+ */
+static void stream_hash_committed(firmware_stream_t *stream)
+{
+    const uint8_t *base = (const uint8_t *)flash_get_partition_base(stream->partition);
+    
+    stream->crc32 = calculate_crc32_update(0, base, stream->flash_offset);
+    sha256_update(&stream->sha256, base, stream->flash_offset);
+}
+
+/**
+ * @brief 单次下载尝试（有断点时用Range续传）
+ */
+static int stream_download_attempt(const char *url, firmware_stream_t *stream)
+{
+    http_request_t request;
+    request.range_start = 0;
+    request.if_range = NULL;
+    
+    if (stream->resumable && stream->flash_offset > 0) {
+        // 断点所在页可能只写了一部分，重新准备
+        if (stream_prepare(stream->partition, stream->flash_offset) != 0) {
+            return -1;
+        }
+        request.range_start = stream->flash_offset;
+        request.if_range = g_session.etag;
+    } else if (stream->flash_offset > 0) {
+        // 无法续传，从头开始
+        if (stream_prepare(stream->partition, 0) != 0) {
+            return -1;
+        }
+        stream->flash_offset = 0;
+        stream->crc32 = 0;
+        sha256_init(&stream->sha256);
+    }
+    
+    stream->fill = 0;
+    
+    uint32_t body_size = 0;
+    http_response_t resp;
+    int ret = http_client_download_stream(url, &request, &resp,
+                                          stream_header_callback, stream_data_callback,
+                                          stream, &body_size, NULL);
+    
+    // 写入最后不足一页的数据
+    if (ret == 0 && stream->fill > 0) {
+        ret = stream_flush_page(stream);
+    }
+    
+    if (ret == 0 && g_session.total_size > 0 && stream->flash_offset != g_session.total_size) {
+        ret = -1;
+    }
+    
+    return ret;
+}
+
+/**
+ * @brief 从URL下载固件并直接流式写入Flash分区
+ */
+int firmware_download_to_partition(const char *url,
+                                   partition_t partition,
+                                   uint32_t *downloaded_size,
+                                   uint32_t *image_crc,
+                                   download_progress_cb progress_cb,
+                                   download_status_cb status_cb)
+{
+    if (url == NULL || partition == PARTITION_NONE || downloaded_size == NULL || image_crc == NULL) {
+        return -1;
+    }
+    
+    download_progress_t progress;
+    firmware_stream_t stream;
+    stream.partition = partition;
+    stream.resumable = stream_load_session(url, partition, &progress);
+    stream.flash_offset = stream.resumable ? progress.committed : 0;
+    stream.crc32 = 0;
+    sha256_init(&stream.sha256);
+    if (stream.resumable) {
+        stream_hash_committed(&stream);
+    }
+    stream.fill = 0;
+    stream.flash_failed = false;
+    stream.progress_cb = progress_cb;
+    g_fail_addr = 0;
+    g_image_sha256_valid = false;
+    
+    if (!stream.resumable) {
+        // 新任务：准备目标分区
+        memset(&g_session, 0, sizeof(g_session));
+        g_session.url_crc = calculate_crc32((const uint8_t *)url, strlen(url));
+        g_session.partition = (uint32_t)partition;
+        
+        if (stream_prepare(partition, 0) != 0) {
+            if (status_cb) {
+                status_cb(DOWNLOAD_FAILED);
+            }
+            return -1;
+        }
+    }
+    
+    if (status_cb) {
+        status_cb(DOWNLOAD_CONNECTING);
+    }
+    
+    int ret = -1;
+    // Flash写入校验失败不是网络问题，不重试
+    for (uint8_t attempt = 0; attempt <= MAX_DOWNLOAD_RETRIES && ret != 0 && !stream.flash_failed;
+         attempt++) {
+        ret = stream_download_attempt(url, &stream);
+    }
+    
+    *downloaded_size = stream.flash_offset;
+    *image_crc = stream.crc32;
+    
+    // 本次下载的擦除次数
+    flash_wear_flush();
+    
+    if (ret != 0) {
+        // 保留断点记录，下次（包括重启后）从断点继续
+        if (status_cb) {
+            status_cb(DOWNLOAD_FAILED);
+        }
+        return -1;
+    }
+    
+    sha256_final(&stream.sha256, g_image_sha256);
+    g_image_sha256_valid = true;
+    
+    // 下载完成，清除断点记录
+    meta_store_delete(META_TAG_OTA_PROGRESS);
+    meta_store_delete(META_TAG_OTA_SESSION);
+    
+    if (status_cb) {
+        status_cb(DOWNLOAD_COMPLETE);
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief 最近一次下载中Flash写入校验失败的地址
+ */
+uint32_t firmware_download_get_fail_addr(void)
+{
+    return g_fail_addr;
+}
+
+/**
+ * @brief 最近一次成功下载的镜像SHA-256
+ */
+int firmware_download_get_sha256(uint8_t *digest)
+{
+    if (digest == NULL || !g_image_sha256_valid) {
+        return -1;
+    }
+    
+    memcpy(digest, g_image_sha256, SHA256_DIGEST_SIZE);
+    return 0;
+}
+
+/**
+ * @brief 验证固件CRC32
+ */
+bool firmware_verify_crc32(const uint8_t *data, uint32_t size, uint32_t expected_crc)
+{
+    uint32_t calculated_crc = calculate_crc32(data, size);
+    return (calculated_crc == expected_crc);
+}
+
+/**
+ * @brief 验证固件SHA-256
+ */
+bool firmware_verify_sha256(const uint8_t *data, uint32_t size, const uint8_t *expected_hash)
+{
+    uint8_t calculated_hash[SHA256_DIGEST_SIZE];
+    
+    if (expected_hash == NULL || calculate_sha256(data, size, calculated_hash) != 0) {
+        return false;
+    }
+    
+    return (memcmp(calculated_hash, expected_hash, SHA256_DIGEST_SIZE) == 0);
+}
@@ -8,6 +8,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "flash_manager.h"
+#include "crc32.h"
+#include "sha256.h"
 
 // 下载状态
 typedef enum {
@@ -19,6 +22,12 @@ typedef enum {
     DOWNLOAD_VERIFYING
 } download_status_t;
 
+// 断点续传记录间隔（页）：每写完这么多页记录一次断点，
+// 掉电后最多重新下载这么多页，间隔越大系统数据区写入越少
+#ifndef DOWNLOAD_PROGRESS_PAGES
+#define DOWNLOAD_PROGRESS_PAGES  4
+#endif
+
 // 下载回调函数类型
 typedef void (*download_progress_cb)(uint32_t downloaded, uint32_t total);
 typedef void (*download_status_cb)(download_status_t status);
@@ -47,12 +56,53 @@ int firmware_download_from_url(const char *url,
                                download_status_cb status_cb);
 
 /**
- * @brief 计算CRC32校验值
- * @param data 数据指针
- * @param size 数据大小
- * @return CRC32值
+ * @brief 从URL下载固件并直接流式写入Flash分区
+ * @note 数据按页（FLASH_PAGE_SIZE）组装，满一页即写入Flash（写入期间串口数据进入
+ *       接收环形缓冲区），RAM占用为1页，固件最大可达分区容量。
+ *       需服务器提供强ETag才能续传：连接中断后从已写入的位置用
+ *       "Range: bytes=N-"和"If-Range"续传，最多重试MAX_DOWNLOAD_RETRIES次；
+ *       每DOWNLOAD_PROGRESS_PAGES页在Flash中记录一次断点，掉电重启后再次下载
+ *       同一URL时从记录的断点继续。
+ *       目标分区由本函数按FLASH_ERASE_MODE擦除（边下载边擦除时每页编程前擦除该页，
+ *       不在下载开始时整体擦除）；启用FLASH_DIFF_WRITE时每页与现有内容
+ *       比较，只重写不同的页。
+ *       每页写入时逐半字回读比较，同时累加CRC32和SHA-256，写入完成即得到镜像CRC
+ *       和摘要（firmware_download_get_sha256()），不需要再读取分区校验；写入校验失败时立即结束（不重试），
+ *       失败地址由firmware_download_get_fail_addr()获取。
+ * @param url 固件下载URL
+ * @param partition 目标分区
+ * @param downloaded_size 实际下载大小（输出）
+ * @param image_crc 已写入镜像的CRC32（输出，用于partition_info_t.crc32）
+ * @param progress_cb 进度回调函数
+ * @param status_cb 状态回调函数
+ * @return 0成功，-1失败
  */
-uint32_t calculate_crc32(const uint8_t *data, uint32_t size);
+int firmware_download_to_partition(const char *url,
+                                   partition_t partition,
+                                   uint32_t *downloaded_size,
+                                   uint32_t *image_crc,
+                                   download_progress_cb progress_cb,
+                                   download_status_cb status_cb);
+
+/**
+ * @brief 获取最近一次下载中Flash写入校验失败的地址
+ * @return 第一个与数据不符的Flash地址，0表示没有写入失败
+ */
+uint32_t firmware_download_get_fail_addr(void);
+
+/**
+ * @brief 获取最近一次成功下载的镜像SHA-256（下载时逐页计算）
+ * @param digest 摘要（输出，32字节）
+ * @return 0成功，-1最近一次下载未成功
+ */
+int firmware_download_get_sha256(uint8_t *digest);
+
+/**
+ * @brief 指定分区是否有未完成的断点续传任务
+ * @param partition 分区
+ * @return true有（分区内容不能被预擦除）
+ */
+bool firmware_download_has_session(partition_t partition);
 
 /**
  * @brief 验证固件CRC32
@@ -64,22 +114,13 @@ uint32_t calculate_crc32(const uint8_t *data, uint32_t size);
 bool firmware_verify_crc32(const uint8_t *data, uint32_t size, uint32_t expected_crc);
 
 /**
- * @brief 计算MD5哈希值（可选，用于更严格的校验）
- * @param data 数据指针
- * @param size 数据大小
- * @param hash_output 输出哈希值（16字节）
- * @return 0成功，-1失败
- */
-int calculate_md5(const uint8_t *data, uint32_t size, uint8_t *hash_output);
-
-/**
- * @brief 验证固件MD5哈希
+ * @brief 验证固件SHA-256
  * @param data 固件数据
  * @param size 数据大小
- * @param expected_hash 期望的哈希值（16字节）
+ * @param expected_hash 期望的摘要（32字节）
  * @return true校验通过，false校验失败
  */
-bool firmware_verify_md5(const uint8_t *data, uint32_t size, const uint8_t *expected_hash);
+bool firmware_verify_sha256(const uint8_t *data, uint32_t size, const uint8_t *expected_hash);
 
 #endif // FIRMWARE_DOWNLOAD_H
 
@@ -0,0 +1,35 @@
+/**
+ * @file firmware_sign.c
+ * @brief 固件签名验证实现
+ */
+
+#include "firmware_sign.h"
+#include <string.h>
+
+/**
+ * @brief 验证分区中镜像的签名
+ */
+bool firmware_verify_signature(partition_t partition, uint32_t total_size,
+                               const uint8_t *public_key)
+{
+    if (partition == PARTITION_NONE || public_key == NULL ||
+        total_size <= sizeof(firmware_signature_t) || total_size > PARTITION_SIZE) {
+        return false;
+    }
+    
+    // 签名块在镜像末尾，不一定按字对齐，复制出来
+    const uint8_t *image = (const uint8_t *)flash_get_partition_base(partition);
+    uint32_t image_size = total_size - sizeof(firmware_signature_t);
+    firmware_signature_t trailer;
+    memcpy(&trailer, image + image_size, sizeof(trailer));
+    
+    if (trailer.magic != FIRMWARE_SIGNATURE_MAGIC || trailer.image_size != image_size) {
+        return false;
+    }
+    
+    // 固件直接从Flash输入SHA-512，不复制到RAM
+    ed25519_verify_ctx_t ctx;
+    ed25519_verify_init(&ctx, trailer.signature, public_key);
+    ed25519_verify_update(&ctx, image, image_size);
+    return ed25519_verify_final(&ctx) == 0;
+}
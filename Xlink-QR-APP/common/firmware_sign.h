@@ -0,0 +1,38 @@
+/**
+ * @file firmware_sign.h
+ * @brief 固件签名块与签名验证
+ * @note 签名后的镜像 = 固件 || firmware_signature_t（附加在末尾，由
+ *       scripts/sign_firmware.sh生成），整体下载写入分区，partition_info_t.size
+ *       和CRC都包括签名块。签名覆盖固件部分，验证时直接从Flash流式读取。
+ *       公钥由scripts/sign_firmware.sh keygen写入common/signing_key.h
+ *       （FIRMWARE_SIGNING_KEY），Bootloader和应用程序启用签名检查时包含。
+ */
+
+#ifndef FIRMWARE_SIGN_H
+#define FIRMWARE_SIGN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flash_manager.h"
+#include "ed25519.h"
+
+#define FIRMWARE_SIGNATURE_MAGIC   0x4E474953   // "SIGN"
+
+// 签名块（72字节，小端）
+typedef struct {
+    uint8_t signature[ED25519_SIGNATURE_SIZE];   // 对前image_size字节的Ed25519签名
+    uint32_t magic;                              // FIRMWARE_SIGNATURE_MAGIC
+    uint32_t image_size;                         // 签名覆盖的字节数（不含签名块）
+} firmware_signature_t;
+
+/**
+ * @brief 验证分区中镜像的签名
+ * @param partition 分区
+ * @param total_size 写入分区的总大小（固件 + 签名块）
+ * @param public_key 公钥（32字节）
+ * @return true签名有效，false没有签名块或签名无效
+ */
+bool firmware_verify_signature(partition_t partition, uint32_t total_size,
+                               const uint8_t *public_key);
+
+#endif // FIRMWARE_SIGN_H
@@ -4,9 +4,26 @@
  */
 
 #include "flash_manager.h"
+#include "meta_store.h"
+#include "crc32.h"
 #include "../drivers/stm32_hal_wrapper.h"
 #include <string.h>
 
+// Flash操作统计
+static flash_stats_t g_flash_stats;
+
+// 预擦除进度（分区内偏移）
+static uint32_t g_preerase_offset = 0;
+
+// 擦除次数：A、B分区各页，然后是系统数据区各页
+#define WEAR_PARTITION_PAGES  (PARTITION_SIZE / FLASH_PAGE_SIZE)
+#define WEAR_PAGE_COUNT       (2 * WEAR_PARTITION_PAGES + SYSDATA_PAGE_COUNT)
+
+static uint16_t g_wear_count[WEAR_PAGE_COUNT];    // 已保存的计数（首次使用时读取）
+static uint16_t g_wear_delta[WEAR_PAGE_COUNT];    // 尚未保存的增量
+static bool g_wear_loaded = false;
+static uint32_t g_wear_pending = 0;
+
 /**
  * @brief 初始化Flash管理器
  */
@@ -14,6 +31,16 @@ void flash_manager_init(void)
 {
     // 初始化Flash接口
     flash_unlock();
+    
+    // 记录区和擦除次数在首次使用时重新读取
+    meta_store_init();
+#ifndef BOOTLOADER_BUILD
+    // Bootloader不擦除分区，不链接擦除次数表
+    memset(g_wear_delta, 0, sizeof(g_wear_delta));
+    g_wear_loaded = false;
+    g_wear_pending = 0;
+    g_preerase_offset = 0;
+#endif
 }
 
 /**
@@ -51,34 +78,219 @@ partition_t flash_get_target_partition(void)
     return PARTITION_A;
 }
 
+/**
+ * @brief 页地址对应的擦除计数下标
+ * @return 下标，-1表示不记录的页
+ */
+static int flash_wear_index(uint32_t page_addr)
+{
+    if (page_addr >= APP_A_BASE_ADDR && page_addr < APP_B_END_ADDR) {
+        return (int)((page_addr - APP_A_BASE_ADDR) / FLASH_PAGE_SIZE);
+    }
+    if (page_addr >= SYSDATA_BASE_ADDR && page_addr < SYSDATA_BASE_ADDR + SYSDATA_SIZE) {
+        return (int)(2 * WEAR_PARTITION_PAGES + (page_addr - SYSDATA_BASE_ADDR) / FLASH_PAGE_SIZE);
+    }
+    return -1;
+}
+
+/**
+ * @brief 读取已保存的擦除次数（只读取一次）
+ */
+static void flash_wear_load(void)
+{
+    if (g_wear_loaded) {
+        return;
+    }
+    
+    if (meta_store_read(META_TAG_FLASH_WEAR, g_wear_count,
+                        sizeof(g_wear_count)) != sizeof(g_wear_count)) {
+        memset(g_wear_count, 0, sizeof(g_wear_count));
+    }
+    g_wear_loaded = true;
+}
+
+/**
+ * @brief 某页的擦除次数（已保存 + 未保存）
+ */
+static uint32_t flash_wear_get(int index)
+{
+    return (uint32_t)g_wear_count[index] + g_wear_delta[index];
+}
+
+/**
+ * @brief 未保存的擦除次数达到阈值时保存
+ */
+static void flash_wear_flush_if_needed(void)
+{
+    if (g_wear_pending >= FLASH_WEAR_FLUSH_THRESHOLD) {
+        flash_wear_flush();
+    }
+}
+
+/**
+ * @brief 记录一次页擦除
+ */
+void flash_wear_note_erase(uint32_t page_addr)
+{
+    int index = flash_wear_index(page_addr);
+    
+    // 只累计增量，不读写系统数据区（meta_store整理时也会调用）
+    if (index >= 0 && g_wear_delta[index] < 0xFFFF) {
+        g_wear_delta[index]++;
+        g_wear_pending++;
+    }
+}
+
+/**
+ * @brief 保存尚未保存的擦除次数
+ */
+int flash_wear_flush(void)
+{
+    if (g_wear_pending == 0) {
+        return 0;
+    }
+    
+    flash_wear_load();
+    
+    uint16_t merged[WEAR_PAGE_COUNT];
+    for (int i = 0; i < WEAR_PAGE_COUNT; i++) {
+        uint32_t count = flash_wear_get(i);
+        merged[i] = (count > 0xFFFF) ? 0xFFFF : (uint16_t)count;
+    }
+    
+    // 先清零增量：写入时整理记录区产生的擦除计入下一次保存
+    uint16_t delta[WEAR_PAGE_COUNT];
+    memcpy(delta, g_wear_delta, sizeof(delta));
+    uint32_t pending = g_wear_pending;
+    memset(g_wear_delta, 0, sizeof(g_wear_delta));
+    g_wear_pending = 0;
+    
+    if (meta_store_write(META_TAG_FLASH_WEAR, merged, sizeof(merged)) != 0) {
+        // 保存失败，增量恢复，下次再保存
+        for (int i = 0; i < WEAR_PAGE_COUNT; i++) {
+            g_wear_delta[i] += delta[i];
+        }
+        g_wear_pending += pending;
+        return -1;
+    }
+    
+    memcpy(g_wear_count, merged, sizeof(merged));
+    return 0;
+}
+
+/**
+ * @brief 获取分区各页擦除次数的统计
+ */
+int flash_get_wear_stats(partition_t partition, flash_wear_stats_t *stats)
+{
+    if (partition == PARTITION_NONE || stats == NULL) {
+        return -1;
+    }
+    
+    flash_wear_load();
+    
+    int first = flash_wear_index(flash_get_partition_base(partition));
+    stats->min_erases = 0xFFFFFFFF;
+    stats->max_erases = 0;
+    stats->total_erases = 0;
+    
+    for (int i = first; i < first + (int)WEAR_PARTITION_PAGES; i++) {
+        uint32_t count = flash_wear_get(i);
+        if (count < stats->min_erases) {
+            stats->min_erases = count;
+        }
+        if (count > stats->max_erases) {
+            stats->max_erases = count;
+        }
+        stats->total_erases += count;
+    }
+    
+    stats->mean_erases = stats->total_erases / WEAR_PARTITION_PAGES;
+    return 0;
+}
+
+/**
+ * @brief 获取某页的擦除次数
+ */
+uint32_t flash_get_page_erase_count(uint32_t page_addr)
+{
+    int index = flash_wear_index(page_addr - (page_addr % FLASH_PAGE_SIZE));
+    if (index < 0) {
+        return 0;
+    }
+    
+    flash_wear_load();
+    return flash_wear_get(index);
+}
+
 /**
  * @brief 擦除目标分区
  */
 int flash_erase_partition(partition_t partition)
 {
+    return flash_erase_partition_range(partition, 0, PARTITION_SIZE);
+}
+
+/**
+ * @brief 检查Flash页是否为空白（按字比较，遇到非0xFF立即返回）
+ */
+bool flash_page_is_blank(uint32_t page_addr)
+{
+    const uint32_t *p = (const uint32_t *)page_addr;
+    
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 擦除分区内的一段区域
+ */
+int flash_erase_partition_range(partition_t partition, uint32_t offset, uint32_t size)
+{
+    if (partition == PARTITION_NONE || offset + size > PARTITION_SIZE) {
+        return -1;
+    }
+    
     uint32_t base_addr = flash_get_partition_base(partition);
-    uint32_t end_addr = base_addr + PARTITION_SIZE;
+    uint32_t start_addr = base_addr + offset - (offset % FLASH_PAGE_SIZE);
+    uint32_t end_addr = base_addr + offset + size;
+    uint32_t start_time = get_system_tick();
+    int erased = 0;
     
     flash_unlock();
     
-    // 擦除分区内的所有页
-    for (uint32_t addr = base_addr; addr < end_addr; addr += FLASH_PAGE_SIZE) {
-        int ret = flash_erase_page(addr);
-        if (ret != 0) {
-            flash_lock();
-            return -1;
+    // 擦除区域覆盖的所有页（空白页跳过，每页擦除约20~40ms）
+    for (uint32_t addr = start_addr; addr < end_addr; addr += FLASH_PAGE_SIZE) {
+        if (flash_page_is_blank(addr)) {
+            g_flash_stats.pages_blank++;
+            continue;
+        }
+        
+        if (flash_erase_page(addr) != 0) {
+            erased = -1;
+            break;
         }
+        flash_wear_note_erase(addr);
+        g_flash_stats.pages_erased++;
+        erased++;
     }
     
     flash_lock();
-    return 0;
+    
+    g_flash_stats.erase_time_ms += get_system_tick() - start_time;
+    flash_wear_flush_if_needed();
+    return erased;
 }
 
 /**
  * @brief 写入数据到指定分区
  */
 int flash_write_partition(partition_t partition, uint32_t offset,
-                         const uint8_t *data, uint32_t size)
+                         const uint8_t *data, uint32_t size, uint32_t *fail_addr)
 {
     if (offset + size > PARTITION_SIZE) {
         return -1;  // 超出分区大小
@@ -88,33 +300,119 @@ int flash_write_partition(partition_t partition, uint32_t offset,
     uint32_t write_addr = base_addr + offset;
     
     flash_unlock();
+    int ret = flash_program_buffer(write_addr, data, size, fail_addr);
+    flash_lock();
     
-    // 按字（4字节）写入
-    uint32_t words = size / 4;
-    uint32_t remainder = size % 4;
-    const uint32_t *word_data = (const uint32_t *)data;
-    
-    for (uint32_t i = 0; i < words; i++) {
-        int ret = flash_program_word(write_addr + i * 4, word_data[i]);
-        if (ret != 0) {
-            flash_lock();
-            return -1;
+    return ret;
+}
+
+// 页比较结果
+typedef enum {
+    PAGE_DIFF_IDENTICAL = 0,     // 内容相同
+    PAGE_DIFF_PROGRAM,           // 不同的半字处都是空白，只需编程
+    PAGE_DIFF_ERASE              // 需要擦除后编程
+} page_diff_t;
+
+/**
+ * @brief 比较Flash页与新数据（按半字，奇数长度时末字节高位按0xFF比较）
+ */
+static page_diff_t flash_page_compare(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    const uint16_t *flash = (const uint16_t *)addr;
+    page_diff_t result = PAGE_DIFF_IDENTICAL;
+    
+    for (uint32_t i = 0; i < size; i += 2) {
+        uint16_t halfword = data[i];
+        halfword |= (i + 1 < size) ? ((uint16_t)data[i + 1] << 8) : 0xFF00;
+        uint16_t current = flash[i / 2];
+        
+        if (current == halfword) {
+            continue;
+        }
+        if (current != 0xFFFF) {
+            return PAGE_DIFF_ERASE;
         }
+        result = PAGE_DIFF_PROGRAM;
+    }
+    
+    return result;
+}
+
+/**
+ * @brief 差分写入一页
+ */
+int flash_write_partition_diff(partition_t partition, uint32_t offset,
+                               const uint8_t *data, uint32_t size, uint32_t *fail_addr)
+{
+    if (partition == PARTITION_NONE || offset % FLASH_PAGE_SIZE != 0 ||
+        size == 0 || size > FLASH_PAGE_SIZE || offset + size > PARTITION_SIZE) {
+        return -1;
+    }
+    
+    uint32_t base_addr = flash_get_partition_base(partition);
+    uint32_t page_addr = base_addr + offset;
+    page_diff_t diff = flash_page_compare(page_addr, data, size);
+    
+    if (diff == PAGE_DIFF_IDENTICAL) {
+        g_flash_stats.pages_unchanged++;
+        return 0;
     }
     
-    // 处理剩余字节
-    if (remainder > 0) {
-        uint32_t last_word = 0;
-        memcpy(&last_word, data + words * 4, remainder);
-        int ret = flash_program_word(write_addr + words * 4, last_word);
+    int ret = 0;
+    
+    if (diff == PAGE_DIFF_ERASE) {
+        uint32_t start_time = get_system_tick();
+        flash_unlock();
+        ret = flash_erase_page(page_addr);
+        flash_lock();
+        g_flash_stats.erase_time_ms += get_system_tick() - start_time;
         if (ret != 0) {
-            flash_lock();
+            if (fail_addr) {
+                *fail_addr = page_addr;
+            }
             return -1;
         }
+        flash_wear_note_erase(page_addr);
+        g_flash_stats.pages_erased++;
     }
     
+    flash_unlock();
+    ret = flash_program_buffer(page_addr, data, size, fail_addr);
     flash_lock();
-    return 0;
+    
+    g_flash_stats.pages_rewritten++;
+    flash_wear_flush_if_needed();
+    return ret;
+}
+
+/**
+ * @brief 预擦除一步
+ */
+int flash_preerase_step(partition_t partition)
+{
+    if (partition == PARTITION_NONE) {
+        return -1;
+    }
+    
+    uint32_t base_addr = flash_get_partition_base(partition);
+    
+    // 跳过空白页，找到下一个需要擦除的页
+    while (g_preerase_offset < PARTITION_SIZE &&
+           flash_page_is_blank(base_addr + g_preerase_offset)) {
+        g_preerase_offset += FLASH_PAGE_SIZE;
+    }
+    
+    if (g_preerase_offset >= PARTITION_SIZE) {
+        g_preerase_offset = 0;
+        return 0;
+    }
+    
+    if (flash_erase_partition_range(partition, g_preerase_offset, FLASH_PAGE_SIZE) < 0) {
+        return -1;
+    }
+    g_preerase_offset += FLASH_PAGE_SIZE;
+    
+    return 1;
 }
 
 /**
@@ -140,24 +438,11 @@ int flash_read_partition(partition_t partition, uint32_t offset,
 int flash_write_partition_info(partition_t partition,
                                const partition_info_t *info)
 {
-    uint32_t base_addr = flash_get_partition_base(partition);
-    uint32_t info_addr = base_addr + PARTITION_SIZE - sizeof(partition_info_t);
-    
-    flash_unlock();
-    
-    const uint32_t *info_words = (const uint32_t *)info;
-    uint32_t word_count = sizeof(partition_info_t) / 4;
-    
-    for (uint32_t i = 0; i < word_count; i++) {
-        int ret = flash_program_word(info_addr + i * 4, info_words[i]);
-        if (ret != 0) {
-            flash_lock();
-            return -1;
-        }
+    if (partition == PARTITION_NONE) {
+        return -1;
     }
     
-    flash_lock();
-    return 0;
+    return meta_store_write(META_TAG_PARTITION_INFO + partition, info, sizeof(partition_info_t));
 }
 
 /**
@@ -166,10 +451,18 @@ int flash_write_partition_info(partition_t partition,
 int flash_read_partition_info(partition_t partition,
                               partition_info_t *info)
 {
-    uint32_t base_addr = flash_get_partition_base(partition);
-    uint32_t info_addr = base_addr + PARTITION_SIZE - sizeof(partition_info_t);
+    if (partition == PARTITION_NONE) {
+        return -1;
+    }
     
-    memcpy(info, (const void *)info_addr, sizeof(partition_info_t));
+    if (meta_store_read(META_TAG_PARTITION_INFO + partition, info,
+                        sizeof(partition_info_t)) != sizeof(partition_info_t)) {
+        // 日志中没有记录（如烧录器写入的出厂固件），读取分区末尾的信息
+        uint32_t base_addr = flash_get_partition_base(partition);
+        uint32_t info_addr = base_addr + PARTITION_SIZE - sizeof(partition_info_t);
+        
+        memcpy(info, (const void *)info_addr, sizeof(partition_info_t));
+    }
     
     // 验证魔数
     if (info->magic != PARTITION_MAGIC) {
@@ -180,9 +473,9 @@ int flash_read_partition_info(partition_t partition,
 }
 
 /**
- * @brief 标记分区为有效
+ * @brief 设置分区状态（追加一条记录）
  */
-int flash_mark_partition_valid(partition_t partition)
+static int flash_set_partition_status(partition_t partition, uint32_t status)
 {
     partition_info_t info;
     
@@ -190,23 +483,47 @@ int flash_mark_partition_valid(partition_t partition)
         return -1;
     }
     
-    info.status = PARTITION_VALID;
+    if (info.status == status) {
+        return 0;
+    }
+    
+    info.status = status;
     return flash_write_partition_info(partition, &info);
 }
 
+/**
+ * @brief 标记分区为有效
+ */
+int flash_mark_partition_valid(partition_t partition)
+{
+    return flash_set_partition_status(partition, PARTITION_VALID);
+}
+
 /**
  * @brief 标记分区为无效
  */
 int flash_mark_partition_invalid(partition_t partition)
 {
-    partition_info_t info;
+    return flash_set_partition_status(partition, PARTITION_INVALID);
+}
+
+// 固件最大大小（分区末尾保留旧格式分区信息的位置）
+#define PARTITION_IMAGE_MAX_SIZE  (PARTITION_SIZE - sizeof(partition_info_t))
+
+/**
+ * @brief 读取有效分区的信息并检查固件大小
+ */
+static bool flash_read_valid_info(partition_t partition, partition_info_t *info)
+{
+    if (flash_read_partition_info(partition, info) != 0) {
+        return false;
+    }
     
-    if (flash_read_partition_info(partition, &info) != 0) {
-        return -1;
+    if (info->magic != PARTITION_MAGIC || info->status != PARTITION_VALID) {
+        return false;
     }
     
-    info.status = PARTITION_INVALID;
-    return flash_write_partition_info(partition, &info);
+    return info->size > 0 && info->size <= PARTITION_IMAGE_MAX_SIZE;
 }
 
 /**
@@ -216,27 +533,65 @@ bool flash_verify_partition(partition_t partition)
 {
     partition_info_t info;
     
-    if (flash_read_partition_info(partition, &info) != 0) {
+    if (!flash_read_valid_info(partition, &info)) {
         return false;
     }
     
-    if (info.magic != PARTITION_MAGIC) {
+    // 只计算固件部分，与写入时记录的CRC范围相同
+    uint32_t base_addr = flash_get_partition_base(partition);
+    uint32_t calculated_crc = calculate_crc32((const uint8_t *)base_addr, info.size);
+    
+    return (calculated_crc == info.crc32);
+}
+
+/**
+ * @brief 深度验证：固件和填充区
+ */
+bool flash_verify_partition_deep(partition_t partition)
+{
+    partition_info_t info;
+    
+    if (!flash_verify_partition(partition) || !flash_read_valid_info(partition, &info)) {
         return false;
     }
     
-    if (info.status != PARTITION_VALID) {
-        return false;
+    if (info.padding_magic != PARTITION_PADDING_MAGIC) {
+        return true;  // 旧格式信息没有填充区CRC
     }
     
-    // 计算实际CRC32
-    // calculate_crc32在firmware_download.c中定义
-    extern uint32_t calculate_crc32(const uint8_t *data, uint32_t size);
+    return flash_partition_padding_crc(partition, info.size) == info.padding_crc32;
+}
+
+/**
+ * @brief 计算填充区CRC32
+ */
+uint32_t flash_partition_padding_crc(partition_t partition, uint32_t image_size)
+{
+    if (partition == PARTITION_NONE || image_size > PARTITION_IMAGE_MAX_SIZE) {
+        return 0;
+    }
     
     uint32_t base_addr = flash_get_partition_base(partition);
-    uint32_t data_size = PARTITION_SIZE - sizeof(partition_info_t);
-    uint32_t calculated_crc = calculate_crc32((const uint8_t *)base_addr, data_size);
-    
-    return (calculated_crc == info.crc32);
+    return calculate_crc32((const uint8_t *)(base_addr + image_size),
+                           PARTITION_IMAGE_MAX_SIZE - image_size);
+}
+
+/**
+ * @brief 获取Flash操作统计
+ */
+void flash_get_stats(flash_stats_t *stats)
+{
+    if (stats) {
+        *stats = g_flash_stats;
+    }
+}
+
+/**
+ * @brief 清零Flash操作统计
+ */
+void flash_reset_stats(void)
+{
+    memset(&g_flash_stats, 0, sizeof(g_flash_stats));
 }
 
 /**
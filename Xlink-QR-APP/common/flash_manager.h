@@ -14,12 +14,34 @@
 #define FLASH_SIZE               (64 * 1024)  // 64KB
 #define FLASH_PAGE_SIZE          1024         // 1KB per page
 
-// Bootloader占用前8KB
+// 固件签名（Makefile的FIRMWARE_SIGNATURE开关）：Bootloader的BOOTLOADER_VERIFY_SIGNATURE和
+// config.h的ENABLE_SIGNATURE_CHECK都由它得到，两者必须相同（Bootloader要求签名而应用程序
+// 接受未签名固件时，升级后两个分区都无法启动）
+#ifndef FIRMWARE_SIGNATURE
+#define FIRMWARE_SIGNATURE       0
+#endif
+
+// Bootloader占用前8KB；启用固件签名时10KB（签名验证使代码增加约4KB，留出编译器差异的余量）。
+// 修改FIRMWARE_SIGNATURE会改变分区地址，Bootloader和应用程序都要用烧录器重新烧录
+#if FIRMWARE_SIGNATURE
+#define BOOTLOADER_SIZE          (10 * 1024)
+#else
 #define BOOTLOADER_SIZE          (8 * 1024)
+#endif
 #define BOOTLOADER_END_ADDR      (FLASH_BASE_ADDR + BOOTLOADER_SIZE)
 
-// A/B分区配置（每个分区28KB）
+// 系统数据区（Bootloader区末尾2页，保存OTA断点等持久化记录，见meta_store.h）
+// Bootloader代码不能超过 BOOTLOADER_SIZE - SYSDATA_SIZE（6KB，启用签名时8KB，由链接脚本检查）
+#define SYSDATA_PAGE_COUNT       2
+#define SYSDATA_SIZE             (SYSDATA_PAGE_COUNT * FLASH_PAGE_SIZE)
+#define SYSDATA_BASE_ADDR        (BOOTLOADER_END_ADDR - SYSDATA_SIZE)
+
+// A/B分区配置（每个分区28KB，启用固件签名时27KB）
+#if FIRMWARE_SIGNATURE
+#define PARTITION_SIZE           (27 * 1024)
+#else
 #define PARTITION_SIZE           (28 * 1024)
+#endif
 #define APP_A_BASE_ADDR          BOOTLOADER_END_ADDR
 #define APP_A_END_ADDR           (APP_A_BASE_ADDR + PARTITION_SIZE)
 #define APP_B_BASE_ADDR          APP_A_END_ADDR
@@ -30,16 +52,51 @@
 #define PARTITION_VALID          0x00000001
 #define PARTITION_INVALID        0x00000000
 
-// 分区信息结构（位于每个分区末尾）
+// 填充区CRC有效标记（partition_info_t.padding_magic，"PADC"）。旧格式信息的该字段为0
+// 或0xFFFFFFFF；不能用padding_crc32为0表示未记录，填充区CRC本身可能为0
+#define PARTITION_PADDING_MAGIC  0x50414443
+
+// 分区信息结构（记录在系统数据区的日志中，见meta_store.h；
+// 日志中没有记录时读取分区末尾的旧格式信息）
 typedef struct {
     uint32_t magic;              // 魔数
     uint32_t version;            // 固件版本
-    uint32_t crc32;              // CRC32校验值
+    uint32_t crc32;              // 固件（前size字节）的CRC32校验值
     uint32_t size;               // 固件大小
     uint32_t status;             // 分区状态（VALID/INVALID）
-    uint32_t reserved[3];        // 保留字段
+    uint32_t padding_crc32;      // 固件之后到分区末尾信息区之前的填充区CRC32
+    uint32_t padding_magic;      // PARTITION_PADDING_MAGIC表示padding_crc32有效
+    uint32_t reserved[1];        // 保留字段
 } partition_info_t;
 
+// 擦除调度模式（config.h中FLASH_ERASE_MODE选择）
+#define FLASH_ERASE_JIT          0   // 边下载边擦除：每页编程前擦除该页
+#define FLASH_ERASE_PREERASE     1   // 预擦除：启动成功后在空闲时逐页擦除非活动分区
+
+// Flash操作统计（自上次清零以来累计）
+typedef struct {
+    uint32_t pages_erased;       // 实际擦除的页数
+    uint32_t pages_blank;        // 已是空白而跳过擦除的页数
+    uint32_t erase_time_ms;      // 擦除（含空白检查）耗时
+    uint32_t pages_unchanged;    // 差分写入：内容相同而跳过的页数
+    uint32_t pages_rewritten;    // 差分写入：内容不同而重新写入的页数
+} flash_stats_t;
+
+// Flash擦写寿命（STM32F1每页典型10000次）
+#define FLASH_ENDURANCE_CYCLES   10000
+
+// 未保存的擦除次数累计到该值时自动保存（掉电最多丢失这么多次计数）。
+// 大于一个分区的页数，一次下载或预擦除（结束时保存）只写入一条记录（128字节）
+#define FLASH_WEAR_FLUSH_THRESHOLD  32
+
+// 分区擦除次数统计（持久化，跨重启累计）
+typedef struct {
+    uint32_t min_erases;         // 擦除次数最少的页
+    uint32_t max_erases;         // 擦除次数最多的页（与FLASH_ENDURANCE_CYCLES比较）
+    uint32_t mean_erases;        // 每页平均擦除次数（向下取整）
+    uint32_t total_erases;       // 分区内所有页擦除次数之和
+} flash_wear_stats_t;
+
 // 分区枚举
 typedef enum {
     PARTITION_A = 0,
@@ -63,19 +120,105 @@ partition_t flash_get_current_partition(void);
 partition_t flash_get_target_partition(void);
 
 /**
- * @brief 擦除目标分区
+ * @brief 擦除目标分区（已是空白的页跳过）
+ * @return 实际擦除的页数，-1失败
  */
 int flash_erase_partition(partition_t partition);
 
+/**
+ * @brief 擦除分区内的一段区域（按页，offset和size向页边界扩展）
+ * @param partition 目标分区
+ * @param offset 分区内偏移地址
+ * @param size 区域大小
+ * @return 实际擦除的页数，-1失败
+ * @note 每页擦除前先做空白检查，已全为0xFF的页不擦除
+ */
+int flash_erase_partition_range(partition_t partition, uint32_t offset, uint32_t size);
+
+/**
+ * @brief 检查Flash页是否为空白（全0xFF）
+ * @param page_addr 页地址
+ * @return true空白
+ */
+bool flash_page_is_blank(uint32_t page_addr);
+
+/**
+ * @brief 获取Flash操作统计
+ * @param stats 统计信息（输出）
+ */
+void flash_get_stats(flash_stats_t *stats);
+
+/**
+ * @brief 清零Flash操作统计
+ */
+void flash_reset_stats(void);
+
+/**
+ * @brief 获取分区各页擦除次数的统计
+ * @param partition 分区
+ * @param stats 统计信息（输出）
+ * @return 0成功，-1失败
+ * @note 计数保存在系统数据区（META_TAG_FLASH_WEAR），包括尚未保存的部分
+ */
+int flash_get_wear_stats(partition_t partition, flash_wear_stats_t *stats);
+
+/**
+ * @brief 获取某页的擦除次数
+ * @param page_addr 页内任意地址（A/B分区或系统数据区）
+ * @return 擦除次数，其他地址返回0
+ */
+uint32_t flash_get_page_erase_count(uint32_t page_addr);
+
+/**
+ * @brief 记录一次页擦除（只累计在RAM中）
+ * @param page_addr 页地址
+ * @note flash_manager内部的擦除自动记录；直接调用flash_erase_page的模块
+ *       （如meta_store）擦除成功后调用
+ */
+void flash_wear_note_erase(uint32_t page_addr);
+
+/**
+ * @brief 保存尚未保存的擦除次数
+ * @return 0成功（或没有需要保存的），-1失败
+ * @note 分区擦除操作在累计达到FLASH_WEAR_FLUSH_THRESHOLD时自动保存；
+ *       一次下载或预擦除结束时调用，不能在meta_store内部调用
+ */
+int flash_wear_flush(void);
+
 /**
  * @brief 写入数据到指定分区
  * @param partition 目标分区
  * @param offset 分区内偏移地址
  * @param data 数据指针
  * @param size 数据大小
+ * @param fail_addr 第一个与数据不符的Flash地址（输出，可选）
+ * @return 0成功（写入内容已逐半字回读比较），-1失败
  */
 int flash_write_partition(partition_t partition, uint32_t offset, 
-                         const uint8_t *data, uint32_t size);
+                         const uint8_t *data, uint32_t size, uint32_t *fail_addr);
+
+/**
+ * @brief 差分写入一页：与Flash现有内容比较，只写入不同的页
+ * @param partition 目标分区
+ * @param offset 分区内偏移地址（必须页对齐）
+ * @param data 页数据
+ * @param size 数据大小（不超过一页，最后一页可以不满）
+ * @param fail_addr 第一个与数据不符的Flash地址（输出，可选）
+ * @return 0成功（页内容与数据一致），-1失败
+ * @note 内容相同的页不擦除也不编程；需要写入的半字处都是空白时只编程；
+ *       否则擦除该页后编程。分区信息保存在系统数据区的日志中，分区末尾的
+ *       旧格式信息只在日志没有记录时读取，不需要清除。
+ */
+int flash_write_partition_diff(partition_t partition, uint32_t offset,
+                               const uint8_t *data, uint32_t size, uint32_t *fail_addr);
+
+/**
+ * @brief 预擦除一步：擦除分区中下一个非空白页
+ * @param partition 目标分区
+ * @return 1还有页待擦除，0整个分区已是空白，-1失败
+ * @note 每次最多擦除一页，适合在空闲时反复调用
+ */
+int flash_preerase_step(partition_t partition);
 
 /**
  * @brief 读取分区数据
@@ -84,32 +227,50 @@ int flash_read_partition(partition_t partition, uint32_t offset,
                         uint8_t *data, uint32_t size);
 
 /**
- * @brief 写入分区信息
+ * @brief 写入分区信息（向系统数据区追加一条记录，不擦除）
  */
 int flash_write_partition_info(partition_t partition, 
                                const partition_info_t *info);
 
 /**
- * @brief 读取分区信息
+ * @brief 读取分区信息（最新的日志记录，没有时读取分区末尾的旧格式信息）
+ * @return 0成功，-1没有分区信息
  */
 int flash_read_partition_info(partition_t partition, 
                               partition_info_t *info);
 
 /**
  * @brief 标记分区为有效
+ * @note 追加一条状态为VALID的分区信息记录，状态未变化时不写入
  */
 int flash_mark_partition_valid(partition_t partition);
 
 /**
  * @brief 标记分区为无效
+ * @note 追加一条状态为INVALID的分区信息记录，状态未变化时不写入
  */
 int flash_mark_partition_invalid(partition_t partition);
 
 /**
  * @brief 验证分区完整性（CRC32校验）
+ * @note 只校验分区信息中记录的固件大小（info.size），耗时与固件大小成正比
  */
 bool flash_verify_partition(partition_t partition);
 
+/**
+ * @brief 深度验证：固件CRC之外再校验填充区CRC（检测填充区被改写）
+ * @note 需要读取整个分区；没有记录填充区CRC（旧格式信息）时只校验固件
+ */
+bool flash_verify_partition_deep(partition_t partition);
+
+/**
+ * @brief 计算填充区（固件之后到分区末尾信息区之前）的CRC32
+ * @param partition 分区
+ * @param image_size 固件大小
+ * @return 填充区CRC32（用于partition_info_t.padding_crc32）
+ */
+uint32_t flash_partition_padding_crc(partition_t partition, uint32_t image_size);
+
 /**
  * @brief 获取分区基地址
  */
@@ -0,0 +1,396 @@
+/**
+ * @file meta_store.c
+ * @brief 持久化记录存储实现
+ * @note 系统数据区的两页轮换使用：当前页写满时，把每种类型的最新记录复制到
+ *       另一页，最后写入带更大序号的页头，新页才生效。页头写入前掉电，
+ *       旧页仍然完整有效；任何时刻掉电都不会丢失已写入的记录。
+ */
+
+#include "meta_store.h"
+#include "flash_manager.h"
+#include "crc32.h"
+#include "../drivers/stm32_hal_wrapper.h"
+#include <string.h>
+
+// 页头（位于每页开头，整理完成后最后写入）
+typedef struct {
+    uint32_t seq;        // 页序号，每整理一次加1，两页都有效时序号大的为当前页
+    uint32_t seq_check;  // ~seq，页头写入中断时校验失败
+    uint32_t magic;      // 页魔数
+} meta_page_header_t;
+
+// 记录头（数据紧随其后，按4字节对齐）
+typedef struct {
+    uint16_t tag;        // 记录类型（0xFFFF表示空闲区域）
+    uint16_t length;     // 数据长度
+    uint32_t seq;        // 记录序号，同类型中序号最大的有效记录为最新记录
+    uint32_t crc32;      // 记录头（本字段按0xFFFFFFFF计算）和数据的CRC32
+} meta_record_header_t;
+
+#define META_PAGE_MAGIC       0x4D455441   // "META"
+#define META_FREE_TAG         0xFFFF
+#define META_PAGE_COUNT       SYSDATA_PAGE_COUNT
+#define META_PAGE_ADDR(i)     (SYSDATA_BASE_ADDR + (uint32_t)(i) * FLASH_PAGE_SIZE)
+#define META_ALIGN(len)       (((len) + 3u) & ~3u)
+#define META_RECORD_SIZE(len) (sizeof(meta_record_header_t) + META_ALIGN(len))
+
+// 当前页（0表示尚未扫描或记录区未格式化）
+static uint32_t g_page_addr = 0;
+static uint32_t g_page_seq = 0;
+
+// 下一条记录的写入地址和序号
+static uint32_t g_write_addr = 0;
+static uint32_t g_next_seq = 0;
+
+/**
+ * @brief 读取页头，判断页是否有效
+ */
+static bool meta_page_valid(uint32_t page_addr, uint32_t *seq)
+{
+    const meta_page_header_t *page = (const meta_page_header_t *)page_addr;
+    
+    if (page->magic != META_PAGE_MAGIC || page->seq_check != ~page->seq) {
+        return false;
+    }
+    
+    *seq = page->seq;
+    return true;
+}
+
+/**
+ * @brief 读取记录头，判断是否为合法记录
+ * @return true合法（CRC可能不匹配），false到达空闲区或记录损坏
+ */
+static bool meta_header_at(uint32_t addr, meta_record_header_t *hdr)
+{
+    uint32_t page_end = g_page_addr + FLASH_PAGE_SIZE;
+    
+    if (addr + sizeof(meta_record_header_t) > page_end) {
+        return false;
+    }
+    
+    memcpy(hdr, (const void *)addr, sizeof(*hdr));
+    
+    if (hdr->tag == META_FREE_TAG) {
+        return false;
+    }
+    
+    if (hdr->length > META_RECORD_MAX_LEN ||
+        addr + META_RECORD_SIZE(hdr->length) > page_end) {
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief 计算记录CRC（记录头的crc32字段按0xFFFFFFFF计算）
+ */
+static uint32_t meta_record_crc(const meta_record_header_t *hdr, const void *data)
+{
+    uint8_t buf[sizeof(meta_record_header_t) + META_RECORD_MAX_LEN];
+    meta_record_header_t *tmp = (meta_record_header_t *)buf;
+    
+    *tmp = *hdr;
+    tmp->crc32 = 0xFFFFFFFF;
+    if (hdr->length > 0) {
+        memcpy(buf + sizeof(*tmp), data, hdr->length);
+    }
+    
+    return calculate_crc32(buf, sizeof(*tmp) + hdr->length);
+}
+
+/**
+ * @brief 记录CRC是否正确
+ */
+static bool meta_record_valid(uint32_t addr, const meta_record_header_t *hdr)
+{
+    const void *data = (const void *)(addr + sizeof(meta_record_header_t));
+    return meta_record_crc(hdr, data) == hdr->crc32;
+}
+
+/**
+ * @brief 扫描当前页的记录，确定写入地址和下一个记录序号
+ */
+static void meta_scan_records(void)
+{
+    meta_record_header_t hdr;
+    uint32_t addr = g_page_addr + sizeof(meta_page_header_t);
+    
+    g_next_seq = 0;
+    while (meta_header_at(addr, &hdr)) {
+        if (hdr.seq >= g_next_seq && meta_record_valid(addr, &hdr)) {
+            g_next_seq = hdr.seq + 1;
+        }
+        addr += META_RECORD_SIZE(hdr.length);
+    }
+    
+    // 遇到损坏的记录头时后面的区域不可用，下次写入触发整理
+    if (addr + sizeof(meta_record_header_t) <= g_page_addr + FLASH_PAGE_SIZE &&
+        hdr.tag != META_FREE_TAG) {
+        addr = g_page_addr + FLASH_PAGE_SIZE;
+    }
+    
+    g_write_addr = addr;
+}
+
+/**
+ * @brief 找出当前页（两页都有效时取序号大的）
+ * @return true找到，false记录区未格式化
+ */
+static bool meta_mount(void)
+{
+    if (g_page_addr != 0) {
+        return true;
+    }
+    
+    for (uint32_t i = 0; i < META_PAGE_COUNT; i++) {
+        uint32_t seq;
+        
+        if (meta_page_valid(META_PAGE_ADDR(i), &seq) &&
+            (g_page_addr == 0 || seq > g_page_seq)) {
+            g_page_addr = META_PAGE_ADDR(i);
+            g_page_seq = seq;
+        }
+    }
+    
+    if (g_page_addr == 0) {
+        return false;
+    }
+    
+    meta_scan_records();
+    return true;
+}
+
+/**
+ * @brief 查找指定类型的最新有效记录（序号最大）
+ * @return 记录地址，0表示没有
+ */
+static uint32_t meta_find(uint16_t tag, meta_record_header_t *out)
+{
+    meta_record_header_t hdr;
+    uint32_t found = 0;
+    
+    for (uint32_t addr = g_page_addr + sizeof(meta_page_header_t); meta_header_at(addr, &hdr);
+         addr += META_RECORD_SIZE(hdr.length)) {
+        if (hdr.tag == tag && (found == 0 || hdr.seq > out->seq) &&
+            meta_record_valid(addr, &hdr)) {
+            found = addr;
+            *out = hdr;
+        }
+    }
+    
+    return found;
+}
+
+/**
+ * @brief 编程一段数据，对齐填充部分保持0xFF
+ */
+static int meta_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    return flash_program_buffer(addr, data, len, NULL);
+}
+
+/**
+ * @brief 擦除一页（已是空白则跳过）
+ * @note 调用前Flash已解锁
+ */
+static int meta_erase_page(uint32_t page_addr)
+{
+    if (flash_page_is_blank(page_addr)) {
+        return 0;
+    }
+    
+    if (flash_erase_page(page_addr) != 0) {
+        return -1;
+    }
+    flash_wear_note_erase(page_addr);
+    return 0;
+}
+
+/**
+ * @brief 写入页头，页从此生效
+ */
+static int meta_commit_page(uint32_t page_addr, uint32_t seq)
+{
+    meta_page_header_t page;
+    page.seq = seq;
+    page.seq_check = ~seq;
+    page.magic = META_PAGE_MAGIC;
+    
+    return meta_program(page_addr, (const uint8_t *)&page, sizeof(page));
+}
+
+/**
+ * @brief 格式化记录区：在第一页写入页头
+ */
+static int meta_format(void)
+{
+    flash_unlock();
+    int ret = meta_erase_page(META_PAGE_ADDR(0));
+    if (ret == 0) {
+        ret = meta_commit_page(META_PAGE_ADDR(0), 1);
+    }
+    flash_lock();
+    
+    if (ret != 0) {
+        return -1;
+    }
+    
+    g_page_addr = 0;
+    return meta_mount() ? 0 : -1;
+}
+
+/**
+ * @brief 整理记录区：把每种类型的最新记录复制到另一页
+ * @note 新页的页头最后写入，复制过程中掉电时旧页仍是当前页
+ */
+static int meta_compact(void)
+{
+    uint32_t src_page = g_page_addr;
+    uint32_t dst_page = (src_page == META_PAGE_ADDR(0)) ? META_PAGE_ADDR(1) : META_PAGE_ADDR(0);
+    uint32_t dst_addr = dst_page + sizeof(meta_page_header_t);
+    meta_record_header_t hdr;
+    
+    flash_unlock();
+    
+    int ret = meta_erase_page(dst_page);
+    
+    for (uint32_t addr = src_page + sizeof(meta_page_header_t);
+         ret == 0 && meta_header_at(addr, &hdr); addr += META_RECORD_SIZE(hdr.length)) {
+        meta_record_header_t newest;
+        
+        // 只保留同类型中最新的有效记录，删除记录（长度0）直接丢弃
+        if (hdr.length == 0 || meta_find(hdr.tag, &newest) != addr) {
+            continue;
+        }
+        
+        // 记录原样复制（包括序号和CRC），新页最多与旧页一样满
+        uint32_t size = META_RECORD_SIZE(hdr.length);
+        ret = meta_program(dst_addr, (const uint8_t *)addr, size);
+        dst_addr += size;
+    }
+    
+    if (ret == 0) {
+        ret = meta_commit_page(dst_page, g_page_seq + 1);
+    }
+    flash_lock();
+    
+    if (ret != 0) {
+        return -1;
+    }
+    
+    g_page_addr = 0;
+    return meta_mount() ? 0 : -1;
+}
+
+/**
+ * @brief 初始化
+ */
+void meta_store_init(void)
+{
+    g_page_addr = 0;
+}
+
+/**
+ * @brief 读取指定类型的最新记录
+ */
+int meta_store_read(uint16_t tag, void *data, uint16_t size)
+{
+    meta_record_header_t hdr;
+    
+    if (!meta_mount()) {
+        return -1;
+    }
+    
+    uint32_t addr = meta_find(tag, &hdr);
+    if (addr == 0 || hdr.length == 0) {
+        return -1;
+    }
+    
+    uint16_t len = (hdr.length < size) ? hdr.length : size;
+    memcpy(data, (const void *)(addr + sizeof(meta_record_header_t)), len);
+    return hdr.length;
+}
+
+/**
+ * @brief 追加一条记录
+ */
+int meta_store_write(uint16_t tag, const void *data, uint16_t size)
+{
+    if (tag == META_FREE_TAG || size > META_RECORD_MAX_LEN || (data == NULL && size > 0)) {
+        return -1;
+    }
+    
+    if (!meta_mount() && meta_format() != 0) {
+        return -1;
+    }
+    
+    uint32_t page_end = g_page_addr + FLASH_PAGE_SIZE;
+    if (g_write_addr + META_RECORD_SIZE(size) > page_end) {
+        if (meta_compact() != 0) {
+            return -1;
+        }
+        page_end = g_page_addr + FLASH_PAGE_SIZE;
+        if (g_write_addr + META_RECORD_SIZE(size) > page_end) {
+            return -1;
+        }
+    }
+    
+    uint8_t record[sizeof(meta_record_header_t) + META_RECORD_MAX_LEN];
+    meta_record_header_t *hdr = (meta_record_header_t *)record;
+    hdr->tag = tag;
+    hdr->length = size;
+    hdr->seq = g_next_seq;
+    hdr->crc32 = meta_record_crc(hdr, data);
+    if (size > 0) {
+        memcpy(record + sizeof(*hdr), data, size);
+    }
+    
+    uint32_t addr = g_write_addr;
+    g_write_addr += META_RECORD_SIZE(size);
+    g_next_seq++;
+    
+    // 记录头和数据一次编程（地址递增），任何位置中断都会导致CRC不匹配，记录被忽略
+    flash_unlock();
+    int ret = meta_program(addr, record, sizeof(*hdr) + size);
+    flash_lock();
+    
+    return ret;
+}
+
+/**
+ * @brief 删除指定类型的记录
+ */
+int meta_store_delete(uint16_t tag)
+{
+    meta_record_header_t hdr;
+    
+    if (!meta_mount() || meta_find(tag, &hdr) == 0 || hdr.length == 0) {
+        return 0;  // 没有记录
+    }
+    
+    return meta_store_write(tag, NULL, 0);
+}
+
+/**
+ * @brief 统计当前页中指定类型的记录数
+ */
+int meta_store_count(uint16_t tag)
+{
+    meta_record_header_t hdr;
+    int count = 0;
+    
+    if (!meta_mount()) {
+        return 0;
+    }
+    
+    for (uint32_t addr = g_page_addr + sizeof(meta_page_header_t); meta_header_at(addr, &hdr);
+         addr += META_RECORD_SIZE(hdr.length)) {
+        if (hdr.tag == tag) {
+            count++;
+        }
+    }
+    
+    return count;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file meta_store.h
+ * @brief 持久化记录存储（系统数据区）
+ * @note 记录按追加方式写入系统数据区，每条记录带递增的序号，同一类型中
+ *       序号最大且CRC正确的记录有效。更新记录只需一次追加编程，不擦除；
+ *       当前页写满时才把最新记录整理到另一页，整理过程掉电不丢失记录。
+ */
+
+#ifndef META_STORE_H
+#define META_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 记录类型
+#define META_TAG_OTA_SESSION     0x0001   // OTA断点续传任务信息
+#define META_TAG_OTA_PROGRESS    0x0002   // OTA已提交到Flash的字节数
+#define META_TAG_WIFI_BAUDRATE   0x0003   // 与WiFi模块协商成功的波特率
+#define META_TAG_FLASH_WEAR      0x0004   // 各页擦除次数（见flash_get_wear_stats）
+#define META_TAG_PARTITION_INFO  0x0010   // 分区信息（partition_info_t），加分区号得到各分区的类型
+
+// 单条记录数据最大长度
+#define META_RECORD_MAX_LEN      128
+
+/**
+ * @brief 初始化（上电时调用，下次访问时重新扫描记录区）
+ */
+void meta_store_init(void);
+
+/**
+ * @brief 读取指定类型的最新记录
+ * @param tag 记录类型
+ * @param data 输出缓冲区
+ * @param size 缓冲区大小
+ * @return 记录长度，-1无记录（或已删除）
+ */
+int meta_store_read(uint16_t tag, void *data, uint16_t size);
+
+/**
+ * @brief 追加一条记录
+ * @param tag 记录类型
+ * @param data 记录数据
+ * @param size 数据长度（不超过META_RECORD_MAX_LEN）
+ * @return 0成功，-1失败
+ */
+int meta_store_write(uint16_t tag, const void *data, uint16_t size);
+
+/**
+ * @brief 删除指定类型的记录（追加一条空记录）
+ * @param tag 记录类型
+ * @return 0成功，-1失败
+ */
+int meta_store_delete(uint16_t tag);
+
+/**
+ * @brief 统计当前页中指定类型的记录数（含已被更新的旧记录，用于测试和诊断）
+ * @param tag 记录类型
+ * @return 记录条数
+ */
+int meta_store_count(uint16_t tag);
+
+#endif // META_STORE_H
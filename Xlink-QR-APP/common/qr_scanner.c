@@ -117,3 +117,52 @@ int qr_parse_url(const uint8_t *qr_data, uint32_t qr_data_len,
     return -1;
 }
 
+/**
+ * @brief 十六进制字符转换为数值
+ * @return 0-15，非十六进制字符返回-1
+ */
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief 取出URL片段中的固件SHA-256
+ */
+int qr_extract_sha256(char *url, uint8_t *digest)
+{
+    if (url == NULL || digest == NULL) {
+        return -1;
+    }
+    
+    char *fragment = strchr(url, '#');
+    if (fragment == NULL) {
+        return -1;
+    }
+    *fragment++ = '\0';
+    
+    if (strncmp(fragment, "sha256=", 7) != 0 || strlen(fragment + 7) != 64) {
+        return -1;
+    }
+    fragment += 7;
+    
+    for (int i = 0; i < 32; i++) {
+        int hi = hex_value(fragment[2 * i]);
+        int lo = hex_value(fragment[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        digest[i] = (uint8_t)((hi << 4) | lo);
+    }
+    
+    return 0;
+}
@@ -45,5 +45,14 @@ bool qr_validate_url(const char *url);
 int qr_parse_url(const uint8_t *qr_data, uint32_t qr_data_len,
                  char *url_buffer, uint32_t buffer_size);
 
+/**
+ * @brief 取出URL片段中的固件SHA-256（"...#sha256=<64位十六进制>"）
+ * @note 片段不是请求的一部分，无论是否找到摘要都从URL中去掉
+ * @param url URL字符串（"#"及之后的内容被截去）
+ * @param digest 摘要（输出，32字节）
+ * @return 0成功，-1没有摘要或格式错误
+ */
+int qr_extract_sha256(char *url, uint8_t *digest);
+
 #endif // QR_SCANNER_H
 
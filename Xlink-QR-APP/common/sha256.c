@@ -0,0 +1,197 @@
+/**
+ * @file sha256.c
+ * @brief SHA-256摘要实现
+ */
+
+#include "sha256.h"
+#include <stddef.h>
+#include <string.h>
+
+// 轮常数
+static const uint32_t sha256_k[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+// Cortex-M3的ROR指令可直接完成循环移位
+#define ROR32(x, n)     (((x) >> (n)) | ((x) << (32 - (n))))
+#define BSIG0(x)        (ROR32(x, 2) ^ ROR32(x, 13) ^ ROR32(x, 22))
+#define BSIG1(x)        (ROR32(x, 6) ^ ROR32(x, 11) ^ ROR32(x, 25))
+#define SSIG0(x)        (ROR32(x, 7) ^ ROR32(x, 18) ^ ((x) >> 3))
+#define SSIG1(x)        (ROR32(x, 17) ^ ROR32(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z)     ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)    (((x) & (y)) | ((z) & ((x) | (y))))
+
+// 第i轮使用的消息字：前16轮直接取，之后在16字循环缓冲区中原地扩展
+#define W(i)            w[(i) & 15]
+#define WEXP(i)         (W(i) += SSIG1(W((i) - 2)) + W((i) - 7) + SSIG0(W((i) - 15)))
+
+// 一轮：变量不移动，由调用处轮换参数顺序
+#define ROUND(a, b, c, d, e, f, g, h, i, wi) do {                   \
+        uint32_t t1 = (h) + BSIG1(e) + CH(e, f, g) + sha256_k[i] + (wi); \
+        (d) += t1;                                                  \
+        (h) = t1 + BSIG0(a) + MAJ(a, b, c);                         \
+    } while (0)
+
+// 8轮：工作变量轮换一周
+#define ROUND8(i, wexpr) do {                                       \
+        ROUND(a, b, c, d, e, f, g, h, (i) + 0, wexpr((i) + 0));     \
+        ROUND(h, a, b, c, d, e, f, g, (i) + 1, wexpr((i) + 1));     \
+        ROUND(g, h, a, b, c, d, e, f, (i) + 2, wexpr((i) + 2));     \
+        ROUND(f, g, h, a, b, c, d, e, (i) + 3, wexpr((i) + 3));     \
+        ROUND(e, f, g, h, a, b, c, d, (i) + 4, wexpr((i) + 4));     \
+        ROUND(d, e, f, g, h, a, b, c, (i) + 5, wexpr((i) + 5));     \
+        ROUND(c, d, e, f, g, h, a, b, (i) + 6, wexpr((i) + 6));     \
+        ROUND(b, c, d, e, f, g, h, a, (i) + 7, wexpr((i) + 7));     \
+    } while (0)
+
+/**
+ * @brief 读取大端字
+ */
+static uint32_t sha256_load_be(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/**
+ * @brief 写入大端字
+ */
+static void sha256_store_be(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/**
+ * @brief 压缩一块（64字节）
+ */
+static void sha256_compress(uint32_t *state, const uint8_t *block)
+{
+    uint32_t w[16];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t h = state[7];
+    
+    for (int i = 0; i < 16; i++) {
+        w[i] = sha256_load_be(block + i * 4);
+    }
+    
+    ROUND8(0, W);
+    ROUND8(8, W);
+    for (int i = 16; i < 64; i += 8) {
+        ROUND8(i, WEXP);
+    }
+    
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/**
+ * @brief 开始计算
+ */
+void sha256_init(sha256_ctx_t *ctx)
+{
+    ctx->state[0] = 0x6A09E667;
+    ctx->state[1] = 0xBB67AE85;
+    ctx->state[2] = 0x3C6EF372;
+    ctx->state[3] = 0xA54FF53A;
+    ctx->state[4] = 0x510E527F;
+    ctx->state[5] = 0x9B05688C;
+    ctx->state[6] = 0x1F83D9AB;
+    ctx->state[7] = 0x5BE0CD19;
+    ctx->count = 0;
+}
+
+/**
+ * @brief 输入一段数据
+ */
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t size)
+{
+    uint32_t used = (uint32_t)(ctx->count % SHA256_BLOCK_SIZE);
+    ctx->count += size;
+    
+    // 先补满上次剩下的块
+    if (used > 0) {
+        uint32_t fill = SHA256_BLOCK_SIZE - used;
+        if (size < fill) {
+            memcpy(ctx->buffer + used, data, size);
+            return;
+        }
+        memcpy(ctx->buffer + used, data, fill);
+        sha256_compress(ctx->state, ctx->buffer);
+        data += fill;
+        size -= fill;
+    }
+    
+    // 整块直接从输入压缩，不复制
+    while (size >= SHA256_BLOCK_SIZE) {
+        sha256_compress(ctx->state, data);
+        data += SHA256_BLOCK_SIZE;
+        size -= SHA256_BLOCK_SIZE;
+    }
+    
+    if (size > 0) {
+        memcpy(ctx->buffer, data, size);
+    }
+}
+
+/**
+ * @brief 结束计算
+ */
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest)
+{
+    uint64_t bits = ctx->count * 8;
+    uint32_t used = (uint32_t)(ctx->count % SHA256_BLOCK_SIZE);
+    
+    // 填充：0x80，若干0，最后8字节为大端位长度
+    ctx->buffer[used++] = 0x80;
+    if (used > SHA256_BLOCK_SIZE - 8) {
+        memset(ctx->buffer + used, 0, SHA256_BLOCK_SIZE - used);
+        sha256_compress(ctx->state, ctx->buffer);
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, SHA256_BLOCK_SIZE - 8 - used);
+    sha256_store_be(ctx->buffer + 56, (uint32_t)(bits >> 32));
+    sha256_store_be(ctx->buffer + 60, (uint32_t)bits);
+    sha256_compress(ctx->state, ctx->buffer);
+    
+    for (int i = 0; i < 8; i++) {
+        sha256_store_be(digest + i * 4, ctx->state[i]);
+    }
+}
+
+/**
+ * @brief 计算一段数据的SHA-256
+ */
+int calculate_sha256(const uint8_t *data, uint32_t size, uint8_t *digest)
+{
+    if ((data == NULL && size > 0) || digest == NULL) {
+        return -1;
+    }
+    
+    sha256_ctx_t ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, size);
+    sha256_final(&ctx, digest);
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file sha256.h
+ * @brief SHA-256摘要（FIPS 180-4）
+ * @note 流式接口：sha256_init()，多次sha256_update()，最后sha256_final()，
+ *       上下文约100字节，不使用堆。压缩函数每8轮展开一次（8个工作变量轮换一周，
+ *       不需要移动寄存器），消息扩展使用16字循环缓冲区。
+ *       主机上的速度见tests/test_crypto.c的test_sha_throughput（make test输出）。
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+
+#define SHA256_BLOCK_SIZE    64
+#define SHA256_DIGEST_SIZE   32
+
+// SHA-256上下文
+typedef struct {
+    uint32_t state[8];                   // 中间摘要
+    uint64_t count;                      // 已输入的字节数
+    uint8_t buffer[SHA256_BLOCK_SIZE];   // 不足一块的数据
+} sha256_ctx_t;
+
+/**
+ * @brief 开始计算
+ * @param ctx 上下文
+ */
+void sha256_init(sha256_ctx_t *ctx);
+
+/**
+ * @brief 输入一段数据
+ * @param ctx 上下文
+ * @param data 数据指针
+ * @param size 数据大小
+ */
+void sha256_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 结束计算
+ * @param ctx 上下文（之后需重新sha256_init()才能使用）
+ * @param digest 摘要（输出，32字节）
+ */
+void sha256_final(sha256_ctx_t *ctx, uint8_t *digest);
+
+/**
+ * @brief 计算一段数据的SHA-256
+ * @param data 数据指针
+ * @param size 数据大小
+ * @param digest 摘要（输出，32字节）
+ * @return 0成功，-1失败
+ */
+int calculate_sha256(const uint8_t *data, uint32_t size, uint8_t *digest);
+
+#endif // SHA256_H
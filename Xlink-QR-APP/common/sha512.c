@@ -0,0 +1,169 @@
+/**
+ * @file sha512.c
+ * @brief SHA-512摘要实现
+ */
+
+#include "sha512.h"
+#include <string.h>
+
+// 轮常数
+static const uint64_t sha512_k[80] = {
+    0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+    0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL, 0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+    0xD807AA98A3030242ULL, 0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+    0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+    0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL, 0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+    0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+    0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+    0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL, 0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+    0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+    0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+    0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL, 0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+    0xD192E819D6EF5218ULL, 0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+    0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+    0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL, 0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+    0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+    0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+    0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL, 0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+    0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+    0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+    0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL, 0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL
+};
+
+#define ROR64(x, n)     (((x) >> (n)) | ((x) << (64 - (n))))
+
+/**
+ * @brief 读取大端64位字
+ */
+static uint64_t sha512_load_be(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/**
+ * @brief 写入大端64位字
+ */
+static void sha512_store_be(uint8_t *p, uint64_t v)
+{
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+/**
+ * @brief 压缩一块（128字节）
+ */
+static void sha512_compress(uint64_t *state, const uint8_t *block)
+{
+    uint64_t w[16];
+    uint64_t v[8];
+    
+    // 第i轮的工作变量a..h为V(0)..V(7)：每轮下标偏移减1，不移动数据，
+    // 80轮后偏移回到0
+#define V(k)    v[((k) - i) & 7]
+    memcpy(v, state, sizeof(v));
+    
+    for (int i = 0; i < 80; i++) {
+        // 消息扩展：16字循环缓冲区原地计算
+        if (i < 16) {
+            w[i] = sha512_load_be(block + i * 8);
+        } else {
+            uint64_t w15 = w[(i - 15) & 15];
+            uint64_t w2 = w[(i - 2) & 15];
+            w[i & 15] += (ROR64(w2, 19) ^ ROR64(w2, 61) ^ (w2 >> 6)) + w[(i - 7) & 15] +
+                         (ROR64(w15, 1) ^ ROR64(w15, 8) ^ (w15 >> 7));
+        }
+        
+        uint64_t e = V(4);
+        uint64_t a = V(0);
+        uint64_t t1 = V(7) + (ROR64(e, 14) ^ ROR64(e, 18) ^ ROR64(e, 41)) +
+                      (V(6) ^ (e & (V(5) ^ V(6)))) + sha512_k[i] + w[i & 15];
+        uint64_t t2 = (ROR64(a, 28) ^ ROR64(a, 34) ^ ROR64(a, 39)) +
+                      ((a & V(1)) | (V(2) & (a | V(1))));
+        
+        // 下一轮的a为本轮h所在位置，e为本轮d所在位置
+        V(3) += t1;
+        V(7) = t1 + t2;
+    }
+    
+#undef V
+    
+    for (int i = 0; i < 8; i++) {
+        state[i] += v[i];
+    }
+}
+
+/**
+ * @brief 开始计算
+ */
+void sha512_init(sha512_ctx_t *ctx)
+{
+    static const uint64_t iv[8] = {
+        0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+        0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, 0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+    };
+    
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->count = 0;
+}
+
+/**
+ * @brief 输入一段数据
+ */
+void sha512_update(sha512_ctx_t *ctx, const uint8_t *data, uint32_t size)
+{
+    uint32_t used = (uint32_t)(ctx->count % SHA512_BLOCK_SIZE);
+    ctx->count += size;
+    
+    // 先补满上次剩下的块
+    if (used > 0) {
+        uint32_t fill = SHA512_BLOCK_SIZE - used;
+        if (size < fill) {
+            memcpy(ctx->buffer + used, data, size);
+            return;
+        }
+        memcpy(ctx->buffer + used, data, fill);
+        sha512_compress(ctx->state, ctx->buffer);
+        data += fill;
+        size -= fill;
+    }
+    
+    // 整块直接从输入（如Flash）压缩，不复制
+    while (size >= SHA512_BLOCK_SIZE) {
+        sha512_compress(ctx->state, data);
+        data += SHA512_BLOCK_SIZE;
+        size -= SHA512_BLOCK_SIZE;
+    }
+    
+    if (size > 0) {
+        memcpy(ctx->buffer, data, size);
+    }
+}
+
+/**
+ * @brief 结束计算
+ */
+void sha512_final(sha512_ctx_t *ctx, uint8_t *digest)
+{
+    uint32_t used = (uint32_t)(ctx->count % SHA512_BLOCK_SIZE);
+    
+    // 填充：0x80，若干0，最后16字节为大端位长度（高64位为0）
+    ctx->buffer[used++] = 0x80;
+    if (used > SHA512_BLOCK_SIZE - 16) {
+        memset(ctx->buffer + used, 0, SHA512_BLOCK_SIZE - used);
+        sha512_compress(ctx->state, ctx->buffer);
+        used = 0;
+    }
+    memset(ctx->buffer + used, 0, SHA512_BLOCK_SIZE - 8 - used);
+    sha512_store_be(ctx->buffer + SHA512_BLOCK_SIZE - 8, ctx->count * 8);
+    sha512_compress(ctx->state, ctx->buffer);
+    
+    for (int i = 0; i < 8; i++) {
+        sha512_store_be(digest + i * 8, ctx->state[i]);
+    }
+}
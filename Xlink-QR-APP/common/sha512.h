@@ -0,0 +1,45 @@
+/**
+ * @file sha512.h
+ * @brief SHA-512摘要（FIPS 180-4，Ed25519签名验证使用）
+ * @note 流式接口与sha256.h相同，上下文约200字节，不使用堆。
+ *       Bootloader也链接本模块，压缩函数不展开以减小代码（Cortex-M3上
+ *       64位运算由两条32位指令完成）。
+ */
+
+#ifndef SHA512_H
+#define SHA512_H
+
+#include <stdint.h>
+
+#define SHA512_BLOCK_SIZE    128
+#define SHA512_DIGEST_SIZE   64
+
+// SHA-512上下文
+typedef struct {
+    uint64_t state[8];                   // 中间摘要
+    uint64_t count;                      // 已输入的字节数
+    uint8_t buffer[SHA512_BLOCK_SIZE];   // 不足一块的数据
+} sha512_ctx_t;
+
+/**
+ * @brief 开始计算
+ * @param ctx 上下文
+ */
+void sha512_init(sha512_ctx_t *ctx);
+
+/**
+ * @brief 输入一段数据
+ * @param ctx 上下文
+ * @param data 数据指针（可直接指向Flash）
+ * @param size 数据大小
+ */
+void sha512_update(sha512_ctx_t *ctx, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief 结束计算
+ * @param ctx 上下文（之后需重新sha512_init()才能使用）
+ * @param digest 摘要（输出，64字节）
+ */
+void sha512_final(sha512_ctx_t *ctx, uint8_t *digest);
+
+#endif // SHA512_H
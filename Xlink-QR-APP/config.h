@@ -14,15 +14,18 @@
 #define FLASH_SIZE               (64 * 1024)   // 64KB
 #define FLASH_PAGE_SIZE          1024          // 1KB per page
 
-// Bootloader配置
+// Bootloader和应用分区配置（与flash_manager.h相同，随Makefile的FIRMWARE_SIGNATURE变化）
+#if FIRMWARE_SIGNATURE
+#define BOOTLOADER_SIZE          (10 * 1024)   // 10KB（签名验证代码）
+#define PARTITION_SIZE           (27 * 1024)   // 每个分区27KB
+#else
 #define BOOTLOADER_SIZE          (8 * 1024)    // 8KB
-
-// 应用分区配置
 #define PARTITION_SIZE           (28 * 1024)   // 每个分区28KB
+#endif
 
 // RAM配置（STM32F108T6: 20KB RAM）
-#define FIRMWARE_BUFFER_SIZE     (28 * 1024)   // 固件缓冲区大小
-// 注意：如果RAM不足，可以减小此值，但需要支持分块下载
+// 固件下载时按页流式写入Flash，只需一页缓冲区
+#define FIRMWARE_BUFFER_SIZE     FLASH_PAGE_SIZE  // 1KB
 
 // ==================== UART配置 ====================
 
@@ -36,7 +39,14 @@
 
 // WiFi模块UART（ESP8266等，用于固件下载）
 #define WIFI_UART_NUM            3
+// 上电初始波特率（ESP8266出厂默认）。启用流控时下载前运行时协商提高到最高921600
 #define WIFI_UART_BAUDRATE       115200
+// RTS/CTS流控（PB14(RTS)接模块CTS(GPIO13)，PB13(CTS)接模块RTS(GPIO15)）
+// 启用后Flash擦除、编程期间模块暂停发送，921600波特率下接收缓冲区也不会溢出。
+// 波特率协商需要流控：未启用时（默认）波特率受接收缓冲区能容纳的最长停顿限制，
+// 2KB缓冲区、120ms停顿（AT_MAX_RX_STALL_MS）约为170kbaud，低于最低的候选230400，
+// 因此始终使用115200
+#define WIFI_UART_FLOW_CONTROL   0
 
 // ==================== GPIO配置 ====================
 
@@ -70,6 +80,11 @@
 // HTTP配置
 #define HTTP_TIMEOUT_MS          60000          // 60秒超时
 
+// HTTP下载模式：HTTP_MODE_AT_COMMAND（普通AT模式）或HTTP_MODE_AT_PASSTHROUGH
+// （透传，无+IPD帧头开销，但每次连接退出透传需要约2秒静默，重定向、续传时
+// 每个连接都要退出一次；见test_download的吞吐量测试，整个下载AT模式更快）
+#define HTTP_DOWNLOAD_MODE         HTTP_MODE_AT_COMMAND
+
 // ==================== OTA配置 ====================
 
 // 二维码扫描超时时间（毫秒）
@@ -78,6 +93,15 @@
 // 固件下载超时时间（毫秒）
 #define DOWNLOAD_TIMEOUT_MS      60000         // 60秒
 
+// 差分写入：新固件的每一页先与目标分区现有内容比较，相同的页不擦除也不编程
+// （只改了少量代码的固件通常只需重写几页）。0为下载前擦除整个分区
+#define FLASH_DIFF_WRITE         1
+
+// Flash擦除调度（FLASH_DIFF_WRITE为0时有效）
+// FLASH_ERASE_JIT：边下载边擦除，每页编程前擦除该页（下载开始时不整体擦除）
+// FLASH_ERASE_PREERASE：启动成功后在空闲时逐页预先擦除非活动分区（会清除旧固件）
+#define FLASH_ERASE_MODE         FLASH_ERASE_JIT
+
 // 版本信息在固件中的偏移地址
 #define FIRMWARE_VERSION_OFFSET  0x200
 
@@ -94,8 +118,14 @@
 
 #define CURRENT_DEBUG_LEVEL      DEBUG_LEVEL_INFO
 
-// 启用MD5校验（需要MD5库支持）
-#define ENABLE_MD5_CHECK         0
+// 启用SHA-256校验：二维码URL末尾带"#sha256=<64位十六进制>"，下载时逐页计算的
+// 摘要与之不符则不写入分区信息（没有摘要的二维码被拒绝）
+#define ENABLE_SHA256_CHECK      0
+
+// 启用Ed25519签名校验（下载后、写入分区信息前验证，需要common/signing_key.h，
+// 见scripts/sign_firmware.sh）。与Bootloader的签名验证由Makefile的FIRMWARE_SIGNATURE
+// 同时设置（见flash_manager.h），不能在这里单独修改
+#define ENABLE_SIGNATURE_CHECK   FIRMWARE_SIGNATURE
 
 // 启用HTTPS支持（需要mbedTLS库）
 #define ENABLE_HTTPS             0
@@ -14,14 +14,17 @@
 #define FLASH_SIZE               (64 * 1024)   // 64KB
 #define FLASH_PAGE_SIZE          1024          // 1KB per page
 
-// Bootloader配置
+// Bootloader和应用分区配置（与flash_manager.h相同，随Makefile的FIRMWARE_SIGNATURE变化）
+#if FIRMWARE_SIGNATURE
+#define BOOTLOADER_SIZE          (10 * 1024)   // 10KB（签名验证代码）
+#define PARTITION_SIZE           (27 * 1024)   // 每个分区27KB
+#else
 #define BOOTLOADER_SIZE          (8 * 1024)    // 8KB
-
-// 应用分区配置
 #define PARTITION_SIZE           (28 * 1024)   // 每个分区28KB
+#endif
 
 // RAM配置
-#define FIRMWARE_BUFFER_SIZE     (28 * 1024)   // 固件缓冲区大小（需根据实际RAM调整）
+#define FIRMWARE_BUFFER_SIZE     FLASH_PAGE_SIZE  // 流式下载页缓冲区（1页）
 
 // ==================== UART配置 ====================
 
@@ -39,9 +42,15 @@
 
 // WiFi模块UART（如果使用）
 #define WIFI_UART               USART3
+// 上电初始波特率（ESP8266出厂默认）。启用流控时下载前运行时协商提高到最高921600
 #define WIFI_UART_BAUDRATE      115200
 #define WIFI_UART_TX_PIN        GPIO_PIN_10
 #define WIFI_UART_RX_PIN        GPIO_PIN_11
+// RTS/CTS流控（1启用，需连接PB14(RTS)和PB13(CTS)）。波特率协商需要流控：
+// 未启用时接收缓冲区容纳不了Flash擦除、编程期间的数据，始终使用115200
+#define WIFI_UART_FLOW_CONTROL  0
+#define WIFI_UART_CTS_PIN       GPIO_PIN_13
+#define WIFI_UART_RTS_PIN       GPIO_PIN_14
 
 // ==================== GPIO配置 ====================
 
@@ -67,6 +76,10 @@
 #define HTTP_SERVER_PORT        80
 #define HTTP_TIMEOUT_MS         30000
 
+// HTTP下载模式：HTTP_MODE_AT_COMMAND（普通AT模式）或HTTP_MODE_AT_PASSTHROUGH
+// （透传，无+IPD帧头开销，但每次连接退出透传需要约2秒静默）
+#define HTTP_DOWNLOAD_MODE        HTTP_MODE_AT_COMMAND
+
 // ==================== OTA配置 ====================
 
 // 二维码扫描超时时间（毫秒）
@@ -75,6 +88,15 @@
 // 固件下载超时时间（毫秒）
 #define DOWNLOAD_TIMEOUT_MS     60000
 
+// 差分写入：新固件的每一页先与目标分区现有内容比较，相同的页不擦除也不编程
+// （只改了少量代码的固件通常只需重写几页）。0为下载前擦除整个分区
+#define FLASH_DIFF_WRITE        1
+
+// Flash擦除调度（FLASH_DIFF_WRITE为0时有效）
+// FLASH_ERASE_JIT：边下载边擦除，每页编程前擦除该页（下载开始时不整体擦除）
+// FLASH_ERASE_PREERASE：启动成功后在空闲时逐页预先擦除非活动分区（会清除旧固件）
+#define FLASH_ERASE_MODE        FLASH_ERASE_JIT
+
 // 版本信息在固件中的偏移地址
 #define FIRMWARE_VERSION_OFFSET  0x200
 
@@ -93,8 +115,14 @@
 
 // ==================== 功能开关 ====================
 
-// 启用MD5校验（需要MD5库支持）
-#define ENABLE_MD5_CHECK        0
+// 启用SHA-256校验：二维码URL末尾带"#sha256=<64位十六进制>"，下载时逐页计算的
+// 摘要与之不符则不写入分区信息（没有摘要的二维码被拒绝）
+#define ENABLE_SHA256_CHECK     0
+
+// 启用Ed25519签名校验（下载后、写入分区信息前验证，需要common/signing_key.h，
+// 见scripts/sign_firmware.sh）。与Bootloader的签名验证由Makefile的FIRMWARE_SIGNATURE
+// 同时设置（见flash_manager.h），不能在这里单独修改
+#define ENABLE_SIGNATURE_CHECK  FIRMWARE_SIGNATURE
 
 // 启用HTTPS支持（需要mbedTLS库）
 #define ENABLE_HTTPS            0
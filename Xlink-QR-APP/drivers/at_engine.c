@@ -0,0 +1,245 @@
+/**
+ * @file at_engine.c
+ * @brief AT命令引擎实现
+ */
+
+#include "at_engine.h"
+#include "stm32_hal_wrapper.h"
+#include <string.h>
+
+// 单行响应最大长度（只用于匹配结果标记，更长的行被截断）
+#define AT_LINE_MAX_LEN    64
+
+// 排队的命令
+typedef struct {
+    const char *cmd;
+    const char *expect;
+    uint32_t timeout_ms;
+    at_complete_cb callback;
+    void *ctx;
+} at_command_t;
+
+static uint8_t g_at_uart = 1;
+
+// 命令队列（环形）
+static at_command_t g_queue[AT_QUEUE_SIZE];
+static uint8_t g_queue_head;         // 队首（正在执行或下一条要发送的命令）
+static uint8_t g_queue_count;
+
+static bool g_cmd_sent;              // 队首命令已发出，正在等待响应
+static uint32_t g_cmd_start;         // 队首命令发出时间
+static bool g_failed;                // 自上次at_engine_wait以来有无回调的命令失败
+
+// 当前响应行和完整响应文本
+static char g_line[AT_LINE_MAX_LEN];
+static uint8_t g_line_len;
+static char g_response[AT_RESPONSE_MAX_LEN];
+static uint16_t g_response_len;
+
+/**
+ * @brief 初始化AT引擎
+ */
+void at_engine_init(uint8_t uart_num)
+{
+    g_at_uart = uart_num;
+    g_queue_head = 0;
+    g_queue_count = 0;
+    g_cmd_sent = false;
+    g_failed = false;
+}
+
+/**
+ * @brief 提交一条AT命令
+ */
+int at_engine_submit(const char *cmd, const char *expect, uint32_t timeout_ms,
+                     at_complete_cb callback, void *ctx)
+{
+    if (cmd == NULL || expect == NULL || g_queue_count >= AT_QUEUE_SIZE) {
+        return -1;
+    }
+    
+    // 引擎空闲时丢弃残留数据（如上一次连接未读完的响应）
+    if (g_queue_count == 0) {
+        uint8_t dummy[32];
+        while (uart_read(g_at_uart, dummy, sizeof(dummy)) > 0);
+    }
+    
+    at_command_t *entry = &g_queue[(g_queue_head + g_queue_count) % AT_QUEUE_SIZE];
+    entry->cmd = cmd;
+    entry->expect = expect;
+    entry->timeout_ms = timeout_ms;
+    entry->callback = callback;
+    entry->ctx = ctx;
+    g_queue_count++;
+    
+    return 0;
+}
+
+/**
+ * @brief 队首命令完成：出队并通知调用者
+ */
+static void at_complete(at_result_t result)
+{
+    at_command_t cmd = g_queue[g_queue_head];
+    
+    g_queue_head = (g_queue_head + 1) % AT_QUEUE_SIZE;
+    g_queue_count--;
+    g_cmd_sent = false;
+    
+    // 没有回调的命令由at_engine_wait汇总结果
+    if (cmd.callback) {
+        cmd.callback(result, g_response, cmd.ctx);
+    } else if (result != AT_RESULT_OK) {
+        g_failed = true;
+    }
+}
+
+/**
+ * @brief 发送队首命令（上一条命令完成后立即调用）
+ */
+static void at_send_next(void)
+{
+    if (g_cmd_sent || g_queue_count == 0) {
+        return;
+    }
+    
+    const at_command_t *cmd = &g_queue[g_queue_head];
+    
+    g_line_len = 0;
+    g_response_len = 0;
+    g_response[0] = '\0';
+    
+    uart_send_string(g_at_uart, cmd->cmd);
+    uart_send_string(g_at_uart, "\r\n");
+    
+    g_cmd_sent = true;
+    g_cmd_start = get_system_tick();
+}
+
+/**
+ * @brief 匹配一行完整的响应
+ * @return true命令已完成
+ */
+static bool at_match_line(const at_command_t *cmd)
+{
+    // 去掉行尾的'\r'（回显的命令行以"\r\r\n"结尾）
+    while (g_line_len > 0 && g_line[g_line_len - 1] == '\r') {
+        g_line_len--;
+    }
+    g_line[g_line_len] = '\0';
+    
+    if (strcmp(g_line, cmd->expect) == 0) {
+        at_complete(AT_RESULT_OK);
+        return true;
+    }
+    
+    if (strstr(g_line, "ERROR") != NULL ||
+        strcmp(g_line, "FAIL") == 0 ||
+        strcmp(g_line, "SEND FAIL") == 0) {
+        at_complete(AT_RESULT_ERROR);
+        return true;
+    }
+    
+    // 其他行（回显、"busy p..."、主动上报等）忽略
+    return false;
+}
+
+/**
+ * @brief 处理引擎事件
+ */
+void at_engine_poll(void)
+{
+    at_send_next();
+    
+    while (g_cmd_sent) {
+        const at_command_t *cmd = &g_queue[g_queue_head];
+        uint8_t byte;
+        
+        // 逐字节读取，命令完成时恰好停在匹配的位置
+        if (uart_read(g_at_uart, &byte, 1) == 0) {
+            if ((get_system_tick() - g_cmd_start) >= cmd->timeout_ms) {
+                at_complete(AT_RESULT_TIMEOUT);
+                at_send_next();
+                continue;
+            }
+            return;
+        }
+        
+        if (g_response_len < AT_RESPONSE_MAX_LEN - 1) {
+            g_response[g_response_len++] = (char)byte;
+            g_response[g_response_len] = '\0';
+        }
+        
+        if (byte == '\n') {
+            if (at_match_line(cmd)) {
+                at_send_next();
+            }
+            g_line_len = 0;
+            continue;
+        }
+        
+        if (g_line_len < AT_LINE_MAX_LEN - 1) {
+            g_line[g_line_len++] = (char)byte;
+        }
+        
+        // 发送提示符">"后面没有换行
+        if (cmd->expect[0] == '>' && g_line_len == 1 && byte == '>') {
+            at_complete(AT_RESULT_OK);
+            at_send_next();
+        }
+    }
+}
+
+/**
+ * @brief 是否所有命令都已完成
+ */
+bool at_engine_idle(void)
+{
+    return (g_queue_count == 0);
+}
+
+/**
+ * @brief 等待队列中的命令全部完成
+ */
+int at_engine_wait(void)
+{
+    while (g_queue_count > 0) {
+        at_engine_poll();
+    }
+    
+    bool failed = g_failed;
+    g_failed = false;
+    return failed ? -1 : 0;
+}
+
+// 同步执行状态
+typedef struct {
+    bool done;
+    at_result_t result;
+} at_sync_t;
+
+static void at_sync_callback(at_result_t result, const char *response, void *ctx)
+{
+    at_sync_t *sync = (at_sync_t *)ctx;
+    (void)response;
+    sync->result = result;
+    sync->done = true;
+}
+
+/**
+ * @brief 发送AT命令并等待完成（同步）
+ */
+int at_engine_exec(const char *cmd, const char *expect, uint32_t timeout_ms)
+{
+    at_sync_t sync = { false, AT_RESULT_TIMEOUT };
+    
+    if (at_engine_submit(cmd, expect, timeout_ms, at_sync_callback, &sync) != 0) {
+        return -1;
+    }
+    
+    while (!sync.done) {
+        at_engine_poll();
+    }
+    
+    return (sync.result == AT_RESULT_OK) ? 0 : -1;
+}
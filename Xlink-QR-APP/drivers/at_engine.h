@@ -0,0 +1,83 @@
+/**
+ * @file at_engine.h
+ * @brief AT命令引擎（命令队列 + 事件驱动响应匹配）
+ * @note 命令按提交顺序排队，前一条命令收到期望的响应行后立即发送下一条，
+ *       不需要固定延时。响应按行匹配（"OK"、"SEND OK"、"ERROR"等），
+ *       提示符">"没有换行，收到即匹配。引擎只在有命令等待响应时读取UART，
+ *       并且在匹配完成的那个字节处停止读取，之后的数据（如+IPD）留给调用者。
+ */
+
+#ifndef AT_ENGINE_H
+#define AT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 命令队列深度
+#define AT_QUEUE_SIZE          4
+
+// 响应文本缓冲区大小（保留最近的响应内容，供回调解析）
+#define AT_RESPONSE_MAX_LEN    256
+
+// 命令执行结果
+typedef enum {
+    AT_RESULT_OK = 0,           // 收到期望的响应
+    AT_RESULT_ERROR = -1,       // 收到ERROR/FAIL
+    AT_RESULT_TIMEOUT = -2      // 超时
+} at_result_t;
+
+/**
+ * @brief 命令完成回调
+ * @param result 执行结果
+ * @param response 命令发出后收到的响应文本（以'\0'结尾，超长时只保留开头部分）
+ * @param ctx 用户上下文
+ */
+typedef void (*at_complete_cb)(at_result_t result, const char *response, void *ctx);
+
+/**
+ * @brief 初始化AT引擎
+ * @param uart_num 连接模块的UART编号
+ */
+void at_engine_init(uint8_t uart_num);
+
+/**
+ * @brief 提交一条AT命令（自动追加"\r\n"）
+ * @param cmd 命令字符串（完成回调之前必须保持有效）
+ * @param expect 期望的响应（如"OK"、">"、"SEND OK"）
+ * @param timeout_ms 从命令发出开始计算的超时时间
+ * @param callback 完成回调（可选）
+ * @param ctx 用户上下文
+ * @return 0成功，-1队列已满
+ */
+int at_engine_submit(const char *cmd, const char *expect, uint32_t timeout_ms,
+                     at_complete_cb callback, void *ctx);
+
+/**
+ * @brief 处理引擎事件：读取响应、匹配、超时、发送下一条命令
+ * @note 主循环或等待期间反复调用
+ */
+void at_engine_poll(void);
+
+/**
+ * @brief 是否所有命令都已完成
+ * @return true空闲
+ */
+bool at_engine_idle(void);
+
+/**
+ * @brief 等待队列中的命令全部完成
+ * @return 0自上次等待以来提交的无回调命令都成功，-1其中有命令失败或超时
+ * @note 设置了回调的命令由回调报告结果，不计入这里的返回值
+ */
+int at_engine_wait(void);
+
+/**
+ * @brief 发送AT命令并等待完成（同步）
+ * @param cmd 命令字符串
+ * @param expect 期望的响应
+ * @param timeout_ms 超时时间
+ * @return 0成功，-1失败或超时
+ */
+int at_engine_exec(const char *cmd, const char *expect, uint32_t timeout_ms);
+
+#endif // AT_ENGINE_H
@@ -0,0 +1,145 @@
+/**
+ * @file esp8266_ipd.c
+ * @brief ESP8266 "+IPD" 数据帧解析实现
+ */
+
+#include "esp8266_ipd.h"
+#include <stddef.h>
+
+static const char IPD_PREFIX[] = "+IPD,";
+static const char IPD_CLOSED[] = "CLOSED";
+
+#define IPD_PREFIX_LEN  (sizeof(IPD_PREFIX) - 1)
+#define IPD_CLOSED_LEN  (sizeof(IPD_CLOSED) - 1)
+
+/**
+ * @brief 初始化解析器
+ */
+void ipd_parser_init(ipd_parser_t *parser)
+{
+    parser->state = IPD_STATE_IDLE;
+    parser->prefix_match = 0;
+    parser->closed_match = 0;
+    parser->digits = 0;
+    parser->length = 0;
+    parser->remaining = 0;
+    parser->payload_total = 0;
+    parser->closed = false;
+}
+
+/**
+ * @brief 帧外字节：匹配"+IPD,"和"CLOSED"
+ */
+static void ipd_idle_byte(ipd_parser_t *parser, uint8_t byte)
+{
+    // 两个关键字都没有自重叠前缀，失配时只需检查是否为首字符
+    if (byte == (uint8_t)IPD_PREFIX[parser->prefix_match]) {
+        parser->prefix_match++;
+        if (parser->prefix_match == IPD_PREFIX_LEN) {
+            parser->prefix_match = 0;
+            parser->closed_match = 0;
+            parser->digits = 0;
+            parser->length = 0;
+            parser->state = IPD_STATE_LENGTH;
+            return;
+        }
+    } else {
+        parser->prefix_match = (byte == (uint8_t)IPD_PREFIX[0]) ? 1 : 0;
+    }
+    
+    if (byte == (uint8_t)IPD_CLOSED[parser->closed_match]) {
+        parser->closed_match++;
+        if (parser->closed_match == IPD_CLOSED_LEN) {
+            parser->closed_match = 0;
+            parser->closed = true;
+        }
+    } else {
+        parser->closed_match = (byte == (uint8_t)IPD_CLOSED[0]) ? 1 : 0;
+    }
+}
+
+/**
+ * @brief 长度字段字节："<len>:"或"<id>,<len>:"
+ * @return 0成功，-1格式错误
+ */
+static int ipd_length_byte(ipd_parser_t *parser, uint8_t byte)
+{
+    if (byte >= '0' && byte <= '9') {
+        parser->length = parser->length * 10 + (uint32_t)(byte - '0');
+        parser->digits++;
+        if (parser->length > IPD_MAX_SEGMENT_LEN) {
+            return -1;
+        }
+        return 0;
+    }
+    
+    if (byte == ',' && parser->digits > 0) {
+        // 前面的数字是连接ID，重新解析长度
+        parser->digits = 0;
+        parser->length = 0;
+        return 0;
+    }
+    
+    if (byte == ':' && parser->digits > 0) {
+        parser->remaining = parser->length;
+        parser->state = (parser->remaining > 0) ? IPD_STATE_PAYLOAD : IPD_STATE_IDLE;
+        return 0;
+    }
+    
+    return -1;
+}
+
+/**
+ * @brief 输入从模块收到的原始字节
+ */
+int ipd_parser_feed(ipd_parser_t *parser, const uint8_t *data, uint32_t len,
+                    ipd_payload_cb payload_cb, void *ctx)
+{
+    if (parser == NULL || (data == NULL && len > 0)) {
+        return -1;
+    }
+    
+    uint32_t i = 0;
+    
+    while (i < len) {
+        switch (parser->state) {
+            case IPD_STATE_IDLE:
+                ipd_idle_byte(parser, data[i++]);
+                break;
+                
+            case IPD_STATE_LENGTH:
+                if (ipd_length_byte(parser, data[i++]) != 0) {
+                    // 帧头损坏，回到帧外重新同步
+                    parser->state = IPD_STATE_IDLE;
+                    return -1;
+                }
+                break;
+                
+            case IPD_STATE_PAYLOAD: {
+                // 载荷整段交给回调，不逐字节拷贝
+                uint32_t n = len - i;
+                if (n > parser->remaining) {
+                    n = parser->remaining;
+                }
+                
+                parser->remaining -= n;
+                parser->payload_total += n;
+                if (parser->remaining == 0) {
+                    parser->state = IPD_STATE_IDLE;
+                }
+                
+                if (payload_cb && payload_cb(&data[i], n, ctx) != 0) {
+                    return -1;
+                }
+                i += n;
+                break;
+            }
+                
+            default:
+                parser->state = IPD_STATE_IDLE;
+                break;
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file esp8266_ipd.h
+ * @brief ESP8266 "+IPD" 数据帧解析器
+ * @note AT普通模式下，模块在每个TCP数据段前插入"+IPD,<len>:"（多连接时为
+ *       "+IPD,<id>,<len>:"）。解析器逐字节识别帧头，记录当前段剩余长度，
+ *       并把载荷以连续片段的形式直接交给回调，不做中间拷贝。
+ */
+
+#ifndef ESP8266_IPD_H
+#define ESP8266_IPD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 单个数据段的最大长度（ESP8266一次最多上报2920字节，留出余量）
+#define IPD_MAX_SEGMENT_LEN   8192
+
+// 解析状态
+typedef enum {
+    IPD_STATE_IDLE = 0,     // 帧外（AT响应文本）
+    IPD_STATE_LENGTH,       // 解析"<id>,<len>:"
+    IPD_STATE_PAYLOAD       // 透传载荷
+} ipd_state_t;
+
+// 解析器上下文
+typedef struct {
+    ipd_state_t state;
+    uint8_t prefix_match;       // 已匹配的"+IPD,"字符数
+    uint8_t closed_match;       // 已匹配的"CLOSED"字符数
+    uint8_t digits;             // 当前长度字段的位数
+    uint32_t length;            // 正在解析的长度字段
+    uint32_t remaining;         // 当前段剩余载荷字节数
+    uint32_t payload_total;     // 累计载荷字节数
+    bool closed;                // 收到"CLOSED"（连接已关闭）
+} ipd_parser_t;
+
+/**
+ * @brief 载荷回调
+ * @param data 载荷片段（指向调用者的输入数据）
+ * @param len 片段长度
+ * @param ctx 用户上下文
+ * @return 0继续，-1中止
+ */
+typedef int (*ipd_payload_cb)(const uint8_t *data, uint32_t len, void *ctx);
+
+/**
+ * @brief 初始化解析器
+ * @param parser 解析器上下文
+ */
+void ipd_parser_init(ipd_parser_t *parser);
+
+/**
+ * @brief 输入从模块收到的原始字节
+ * @param parser 解析器上下文
+ * @param data 原始数据
+ * @param len 数据长度
+ * @param payload_cb 载荷回调
+ * @param ctx 传给payload_cb的用户上下文
+ * @return 0成功，-1帧格式错误或回调中止
+ */
+int ipd_parser_feed(ipd_parser_t *parser, const uint8_t *data, uint32_t len,
+                    ipd_payload_cb payload_cb, void *ctx);
+
+#endif // ESP8266_IPD_H
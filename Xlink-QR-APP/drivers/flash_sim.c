@@ -0,0 +1,324 @@
+/**
+ * @file flash_sim.c
+ * @brief 主机Flash模拟器实现
+ * @note 只在定义FLASH_SIM的主机构建中编译，芯片构建时本文件为空
+ */
+
+#ifdef FLASH_SIM
+
+#include "flash_sim.h"
+#include "stm32_hal_wrapper.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 镜像文件和两个映射：只读映射在Flash地址上供代码读取，可写映射只在模拟器内部使用
+static int g_image_fd = -1;
+static const uint8_t *g_flash_ro = NULL;
+static uint8_t *g_flash_rw = NULL;
+
+static flash_sim_timing_t g_timing = { FLASH_SIM_PAGE_ERASE_US, FLASH_SIM_PROGRAM_US };
+static flash_sim_stats_t g_sim_stats;
+static uint32_t g_erase_count[FLASH_SIM_PAGE_COUNT];
+
+// 掉电前还允许的操作次数（-1不限制）
+static int32_t g_ops_left = -1;
+
+/**
+ * @brief 地址范围是否在模拟Flash内
+ */
+static bool sim_in_range(uint32_t addr, uint32_t len)
+{
+    return addr >= FLASH_SIM_BASE && len <= FLASH_SIM_SIZE &&
+           addr - FLASH_SIM_BASE <= FLASH_SIM_SIZE - len;
+}
+
+/**
+ * @brief 消耗一次操作（模拟掉电）
+ * @return false已掉电
+ */
+static bool sim_consume_op(void)
+{
+    if (g_ops_left == 0) {
+        return false;
+    }
+    if (g_ops_left > 0) {
+        g_ops_left--;
+    }
+    return true;
+}
+
+/**
+ * @brief 擦除地址所在的页
+ */
+static int sim_erase(uint32_t addr)
+{
+    if (g_flash_rw == NULL || !sim_in_range(addr, 1)) {
+        return -1;
+    }
+    
+    if (!sim_consume_op()) {
+        return -1;
+    }
+    
+    uint32_t page = (addr - FLASH_SIM_BASE) / FLASH_SIM_PAGE_SIZE;
+    memset(&g_flash_rw[page * FLASH_SIM_PAGE_SIZE], 0xFF, FLASH_SIM_PAGE_SIZE);
+    g_erase_count[page]++;
+    g_sim_stats.page_erases++;
+    
+    return 0;
+}
+
+/**
+ * @brief 编程一个半字（STM32F1规则：目标必须为空白，写0x0000除外）
+ */
+static int sim_program_halfword(uint32_t addr, uint16_t value)
+{
+    if (g_flash_rw == NULL || (addr & 1) != 0 || !sim_in_range(addr, 2)) {
+        g_sim_stats.program_errors++;
+        return -1;
+    }
+    
+    if (!sim_consume_op()) {
+        return -1;
+    }
+    
+    uint16_t *dest = (uint16_t *)&g_flash_rw[addr - FLASH_SIM_BASE];
+    if (*dest != 0xFFFF && value != 0x0000) {
+        g_sim_stats.program_errors++;   // PGERR，内容不变
+        return -1;
+    }
+    
+    // NOR Flash编程只能把位从1变为0
+    *dest &= value;
+    g_sim_stats.time_us += g_timing.program_us;
+    g_sim_stats.halfwords_programmed++;
+    
+    return 0;
+}
+
+// ==================== 模拟器接口 ====================
+
+int flash_sim_open(const char *image_path)
+{
+    struct stat st;
+    
+    flash_sim_close();
+    
+    g_image_fd = open(image_path, O_RDWR | O_CREAT, 0644);
+    if (g_image_fd < 0 || fstat(g_image_fd, &st) != 0) {
+        flash_sim_close();
+        return -1;
+    }
+    
+    if (st.st_size == 0) {
+        // 新镜像：全部为擦除状态
+        uint8_t blank[FLASH_SIM_PAGE_SIZE];
+        memset(blank, 0xFF, sizeof(blank));
+        for (uint32_t i = 0; i < FLASH_SIM_PAGE_COUNT; i++) {
+            if (write(g_image_fd, blank, sizeof(blank)) != (ssize_t)sizeof(blank)) {
+                flash_sim_close();
+                return -1;
+            }
+        }
+    } else if (st.st_size != FLASH_SIM_SIZE) {
+        flash_sim_close();
+        return -1;
+    }
+    
+    void *ro = mmap((void *)(uintptr_t)FLASH_SIM_BASE, FLASH_SIM_SIZE, PROT_READ,
+                    MAP_SHARED | MAP_FIXED, g_image_fd, 0);
+    void *rw = mmap(NULL, FLASH_SIM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, g_image_fd, 0);
+    if (ro != (void *)(uintptr_t)FLASH_SIM_BASE || rw == MAP_FAILED) {
+        if (rw != MAP_FAILED) {
+            munmap(rw, FLASH_SIM_SIZE);
+        }
+        flash_sim_close();
+        return -1;
+    }
+    
+    g_flash_ro = (const uint8_t *)ro;
+    g_flash_rw = (uint8_t *)rw;
+    g_ops_left = -1;
+    flash_sim_reset_stats();
+    
+    return 0;
+}
+
+void flash_sim_close(void)
+{
+    if (g_flash_rw != NULL) {
+        msync(g_flash_rw, FLASH_SIM_SIZE, MS_SYNC);
+        munmap(g_flash_rw, FLASH_SIM_SIZE);
+        g_flash_rw = NULL;
+    }
+    if (g_flash_ro != NULL) {
+        munmap((void *)g_flash_ro, FLASH_SIM_SIZE);
+        g_flash_ro = NULL;
+    }
+    if (g_image_fd >= 0) {
+        close(g_image_fd);
+        g_image_fd = -1;
+    }
+}
+
+void flash_sim_set_timing(const flash_sim_timing_t *timing)
+{
+    if (timing) {
+        g_timing = *timing;
+    } else {
+        g_timing.page_erase_us = FLASH_SIM_PAGE_ERASE_US;
+        g_timing.program_us = FLASH_SIM_PROGRAM_US;
+    }
+}
+
+void flash_sim_get_stats(flash_sim_stats_t *stats)
+{
+    if (stats) {
+        *stats = g_sim_stats;
+    }
+}
+
+void flash_sim_reset_stats(void)
+{
+    memset(&g_sim_stats, 0, sizeof(g_sim_stats));
+    memset(g_erase_count, 0, sizeof(g_erase_count));
+}
+
+uint32_t flash_sim_get_erase_count(uint32_t page_addr)
+{
+    if (!sim_in_range(page_addr, 1)) {
+        return 0;
+    }
+    return g_erase_count[(page_addr - FLASH_SIM_BASE) / FLASH_SIM_PAGE_SIZE];
+}
+
+void flash_sim_advance_us(uint32_t us)
+{
+    g_sim_stats.time_us += us;
+}
+
+void flash_sim_power_cut(int32_t ops)
+{
+    g_ops_left = (ops < 0) ? -1 : ops;
+}
+
+// ==================== stm32_hal_wrapper.h Flash函数 ====================
+
+void flash_unlock(void)
+{
+    // 与芯片上相同，编程和擦除函数在锁定时自动解锁，这里无需记录
+}
+
+void flash_lock(void)
+{
+}
+
+int flash_erase_page(uint32_t page_addr)
+{
+    if (sim_erase(page_addr) != 0) {
+        return -1;
+    }
+    g_sim_stats.time_us += g_timing.page_erase_us;
+    return 0;
+}
+
+int flash_program_word(uint32_t addr, uint32_t data)
+{
+    if ((addr & 3) != 0) {
+        g_sim_stats.program_errors++;
+        return -1;
+    }
+    
+    // 字编程由两次半字编程完成（低半字在前）
+    if (sim_program_halfword(addr, (uint16_t)data) != 0 ||
+        sim_program_halfword(addr + 2, (uint16_t)(data >> 16)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int flash_program_buffer(uint32_t addr, const uint8_t *data, uint32_t len, uint32_t *fail_addr)
+{
+    if (data == NULL || (addr & 1) != 0 || !sim_in_range(addr, len)) {
+        if (fail_addr) {
+            *fail_addr = addr;
+        }
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < len; i += 2) {
+        uint16_t halfword = data[i];
+        halfword |= (i + 1 < len) ? ((uint16_t)data[i + 1] << 8) : 0xFF00;
+        
+        // 与芯片驱动相同：内容相同跳过，0xFFFF不编程但要求Flash为空白
+        const uint16_t *dest = (const uint16_t *)(uintptr_t)(addr + i);
+        if (*dest == halfword) {
+            continue;
+        }
+        
+        if ((halfword != 0xFFFF && sim_program_halfword(addr + i, halfword) != 0) ||
+            *dest != halfword) {
+            if (fail_addr) {
+                *fail_addr = addr + i;
+            }
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+// ==================== CRC单元模型 ====================
+
+/**
+ * @brief 按位反转
+ */
+static uint32_t sim_rbit(uint32_t value)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 32; i++) {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief CRC单元写入一个字（CRC-32/MPEG-2，逐位计算）
+ */
+static uint32_t sim_crc_write(uint32_t dr, uint32_t word)
+{
+    dr ^= word;
+    for (int i = 0; i < 32; i++) {
+        dr = (dr & 0x80000000) ? (dr << 1) ^ 0x04C11DB7 : dr << 1;
+    }
+    return dr;
+}
+
+uint32_t crc_unit_calc(uint32_t seed, const uint32_t *data, uint32_t words)
+{
+    uint32_t dr = sim_crc_write(0xFFFFFFFF, seed);
+    
+    for (uint32_t i = 0; i < words; i++) {
+        dr = sim_crc_write(dr, sim_rbit(data[i]));
+    }
+    
+    return dr;
+}
+
+// ==================== 系统函数 ====================
+
+uint32_t get_system_tick(void)
+{
+    return (uint32_t)(g_sim_stats.time_us / 1000);
+}
+
+void delay_ms(uint32_t ms)
+{
+    flash_sim_advance_us(ms * 1000);
+}
+
+#endif // FLASH_SIM
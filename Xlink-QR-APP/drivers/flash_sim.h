@@ -0,0 +1,95 @@
+/**
+ * @file flash_sim.h
+ * @brief 主机Flash模拟器（定义FLASH_SIM时代替stm32_hal_wrapper.c的Flash函数）
+ * @note 把64KB镜像文件映射到0x08000000（与芯片地址相同），flash_manager、
+ *       meta_store等模块不做修改即可在Linux上运行。模拟NOR Flash规则：
+ *       只能按半字编程、目标半字必须为空白（写0x0000除外，与STM32F1相同）、
+ *       按页擦除；映射区只读，代码直接写Flash地址会触发段错误。
+ *       CRC单元（crc_unit_calc）按寄存器行为逐位模拟。
+ *       擦除和编程时间按模型累加到模拟时钟，get_system_tick()返回模拟时间，
+ *       flash_stats_t中的耗时即为芯片上的预计耗时。
+ *       主机构建见Makefile的sim目标，链接时需加-Wl,--gc-sections。
+ */
+
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 模拟的Flash（STM32F108T6）
+#define FLASH_SIM_BASE             0x08000000
+#define FLASH_SIM_SIZE             (64 * 1024)
+#define FLASH_SIM_PAGE_SIZE        1024
+#define FLASH_SIM_PAGE_COUNT       (FLASH_SIM_SIZE / FLASH_SIM_PAGE_SIZE)
+
+// 默认时间模型（STM32F1数据手册典型值）
+#define FLASH_SIM_PAGE_ERASE_US    20000   // 页擦除20ms
+#define FLASH_SIM_PROGRAM_US       52      // 半字编程52.5us
+
+// 时间模型
+typedef struct {
+    uint32_t page_erase_us;      // 页擦除时间
+    uint32_t program_us;         // 半字编程时间
+} flash_sim_timing_t;
+
+// 模拟统计（自打开或清零以来累计）
+typedef struct {
+    uint64_t time_us;            // 模拟时间
+    uint32_t page_erases;        // 页擦除次数
+    uint32_t halfwords_programmed; // 编程的半字数
+    uint32_t program_errors;     // 违反NOR规则的编程（目标非空白、地址未对齐或越界）
+} flash_sim_stats_t;
+
+/**
+ * @brief 打开镜像文件并映射到Flash地址
+ * @param image_path 镜像文件路径（不存在时创建，内容为全0xFF）
+ * @return 0成功，-1失败
+ * @note 镜像文件必须是64KB（可用烧录器从芯片读出），修改直接写回文件
+ */
+int flash_sim_open(const char *image_path);
+
+/**
+ * @brief 解除映射并关闭镜像文件
+ */
+void flash_sim_close(void);
+
+/**
+ * @brief 设置时间模型
+ * @param timing 时间模型（NULL恢复默认值）
+ */
+void flash_sim_set_timing(const flash_sim_timing_t *timing);
+
+/**
+ * @brief 获取模拟统计
+ * @param stats 统计信息（输出）
+ */
+void flash_sim_get_stats(flash_sim_stats_t *stats);
+
+/**
+ * @brief 清零模拟统计、模拟时钟和各页擦除次数
+ */
+void flash_sim_reset_stats(void);
+
+/**
+ * @brief 获取某页的擦除次数
+ * @param page_addr 页内任意地址
+ * @return 擦除次数，地址越界时返回0
+ */
+uint32_t flash_sim_get_erase_count(uint32_t page_addr);
+
+/**
+ * @brief 推进模拟时钟（模拟CPU做其他工作，如接收网络数据）
+ * @param us 微秒
+ */
+void flash_sim_advance_us(uint32_t us);
+
+/**
+ * @brief 模拟掉电：再执行ops次擦除或半字编程后，所有Flash操作失败且不改变内容
+ * @param ops 允许的操作次数（-1取消）
+ * @note 掉电后重新"上电"：调用flash_sim_power_cut(-1)和flash_manager_init()，
+ *       再重新初始化其他被测模块
+ */
+void flash_sim_power_cut(int32_t ops);
+
+#endif // FLASH_SIM_H
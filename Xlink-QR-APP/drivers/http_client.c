@@ -5,85 +5,233 @@
 
 #include "http_client.h"
 #include "stm32_hal_wrapper.h"
+#include "at_engine.h"
+#include "esp8266_ipd.h"
+#include "http_parser.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 static http_mode_t g_http_mode = HTTP_MODE_AT_COMMAND;
 static uint8_t g_uart_num = 1;
 
-// AT命令缓冲区
-#define AT_BUFFER_SIZE  512
-static char g_at_buffer[AT_BUFFER_SIZE];
+// 最多跟随的重定向次数
+#define HTTP_MAX_REDIRECTS  3
+
+// 透传模式："+++"前后需要保持的静默时间（ESP8266要求至少1秒）
+#define PASSTHROUGH_GUARD_MS    1000
+
+// 透传模式没有连接关闭通知，长度未知的响应体以静默超时判断结束
+#define PASSTHROUGH_IDLE_MS     3000
+
+// ESP8266出厂默认波特率
+#define AT_DEFAULT_BAUDRATE     115200
+
+// 波特率协商候选（从高到低）
+static const uint32_t g_at_baudrates[] = { 921600, 460800, 230400 };
+
+// 往返探测次数（每次读取模块版本信息，约100字节）
+#define AT_PROBE_ROUNDS         3
+
+// 握手和恢复原波特率的尝试次数
+#define AT_HANDSHAKE_ATTEMPTS   3
+
+// 没有流控时接收回调中最长不读取UART的时间（毫秒）：同步擦除、编程一页
+// （最坏约75ms），加上断点记录触发的系统数据区整理
+#ifndef AT_MAX_RX_STALL_MS
+#define AT_MAX_RX_STALL_MS      120
+#endif
 
 /**
- * @brief 发送AT命令并等待响应
+ * @brief 握手：先发送空行结束模块收到的半条命令（如波特率不一致时的乱码），
+ *        等待可能的ERROR回复到达后再发送AT，失败重试
+ * @return 0成功，-1失败
  */
-static int at_send_command(const char *cmd, const char *expected_response, uint32_t timeout_ms)
+static int at_handshake(uint32_t timeout_ms)
 {
-    // 清空接收缓冲区
-    uint8_t dummy;
-    while (uart_receive_byte(g_uart_num, &dummy) == 0);
+    for (uint8_t i = 0; i < AT_HANDSHAKE_ATTEMPTS; i++) {
+        uart_send_string(g_uart_num, "\r\n");
+        uart_flush(g_uart_num, 100);
+        delay_ms(20);
+        
+        // 提交命令前会丢弃之前未读的回复
+        if (at_engine_exec("AT", "OK", timeout_ms) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 没有流控时可用的最高波特率：最长停顿期间到达的数据不超过接收缓冲区
+ * @return 最高波特率（启用流控时不限制）
+ * @note 2KB接收缓冲区为约170kbaud，低于g_at_baudrates中的最低值，没有流控时不协商
+ */
+static uint32_t at_max_baudrate(void)
+{
+    if (uart_get_flow_control(g_uart_num)) {
+        return UINT32_MAX;
+    }
+    // 每字节10位
+    return (uint32_t)((uint64_t)uart_rx_capacity(g_uart_num) * 10 * 1000 / AT_MAX_RX_STALL_MS);
+}
+
+/**
+ * @brief 往返探测：多次读取模块版本信息，任何字节出错都会导致找不到"OK"
+ * @return 0链路可靠，-1失败
+ */
+static int at_probe_link(void)
+{
+    for (uint8_t i = 0; i < AT_PROBE_ROUNDS; i++) {
+        if (at_engine_exec("AT+GMR", "OK", 500) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 切换模块和UART的波特率并探测
+ * @return 0成功，-1失败（已恢复到原波特率），-2失败且无法恢复
+ */
+static int at_switch_baudrate(uint32_t from, uint32_t to)
+{
+    char cmd[48];
     
-    // 发送AT命令
-    uart_send_string(g_uart_num, cmd);
-    uart_send_string(g_uart_num, "\r\n");
+    // 流控参数3：模块按CTS暂停发送，并用RTS通知MCU暂停
+    uint8_t flow = uart_get_flow_control(g_uart_num) ? 3 : 0;
     
-    // 等待响应
-    uint32_t start_time = get_system_tick();
-    uint32_t buffer_pos = 0;
-    
-    while ((get_system_tick() - start_time) < timeout_ms) {
-        uint8_t byte;
-        if (uart_receive_byte(g_uart_num, &byte) == 0) {
-            if (buffer_pos < AT_BUFFER_SIZE - 1) {
-                g_at_buffer[buffer_pos++] = byte;
-                g_at_buffer[buffer_pos] = '\0';
-                
-                // 检查是否包含期望的响应
-                if (expected_response && strstr((char *)g_at_buffer, expected_response)) {
-                    return 0;  // 成功
-                }
-                
-                // 检查错误响应
-                if (strstr((char *)g_at_buffer, "ERROR") || 
-                    strstr((char *)g_at_buffer, "FAIL")) {
-                    return -1;  // 失败
-                }
-            }
+    // 模块先用原波特率回复OK，然后切换
+    snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%lu,8,1,0,%u", (unsigned long)to, flow);
+    if (at_engine_exec(cmd, "OK", 1000) != 0) {
+        return -1;
+    }
+    
+    delay_ms(20);
+    uart_init(g_uart_num, to);
+    delay_ms(20);
+    
+    if (at_probe_link() == 0) {
+        return 0;
+    }
+    
+    // 新波特率不可靠：用新波特率发送恢复命令（回复可能无法识别，不等待），
+    // 回到原波特率握手确认，失败重发
+    snprintf(cmd, sizeof(cmd), "\r\nAT+UART_CUR=%lu,8,1,0,%u\r\n", (unsigned long)from, flow);
+    for (uint8_t i = 0; i < AT_HANDSHAKE_ATTEMPTS; i++) {
+        uart_init(g_uart_num, to);
+        uart_send_string(g_uart_num, cmd);
+        uart_flush(g_uart_num, 100);
+        delay_ms(20);
+        uart_init(g_uart_num, from);
+        delay_ms(20);
+        
+        if (at_handshake(500) == 0) {
+            return -1;
+        }
+    }
+    
+    return -2;
+}
+
+/**
+ * @brief 与WiFi模块握手并协商波特率
+ * @param cached 上次协商成功的波特率（0表示未知）
+ * @return 当前使用的波特率，0握手失败
+ * @note 没有流控时只使用接收缓冲区能容纳最长停顿的波特率；
+ *       启用流控时模块也要切换为RTS/CTS流控，停留在默认波特率时同样发送AT+UART_CUR
+ */
+static uint32_t at_negotiate_baudrate(uint32_t cached)
+{
+    uint32_t current = 0;
+    uint32_t max_baudrate = at_max_baudrate();
+    bool flow_control = uart_get_flow_control(g_uart_num);
+    
+    // 模块未断电时仍在上次的波特率和流控设置上（默认波特率上无法区分模块是否断电过）
+    if (cached != 0 && cached != AT_DEFAULT_BAUDRATE && cached <= max_baudrate) {
+        uart_init(g_uart_num, cached);
+        if (at_handshake(500) == 0 && at_probe_link() == 0) {
+            return cached;
+        }
+    }
+    
+    uart_init(g_uart_num, AT_DEFAULT_BAUDRATE);
+    if (at_handshake(2000) != 0) {
+        return 0;
+    }
+    current = AT_DEFAULT_BAUDRATE;
+    
+    // 从允许的最高波特率开始尝试，失败则降一级
+    for (uint8_t i = 0; i < sizeof(g_at_baudrates) / sizeof(g_at_baudrates[0]); i++) {
+        if (g_at_baudrates[i] <= current) {
+            break;
+        }
+        if (g_at_baudrates[i] > max_baudrate) {
+            continue;
+        }
+        
+        int ret = at_switch_baudrate(current, g_at_baudrates[i]);
+        if (ret == 0) {
+            return g_at_baudrates[i];
         }
-        delay_ms(10);
+        // 未能回到原波特率，无法继续
+        if (ret < -1) {
+            return 0;
+        }
+    }
+    
+    // 模块上电时没有流控
+    if (flow_control && at_switch_baudrate(current, current) < -1) {
+        return 0;
     }
     
-    return -1;  // 超时
+    return current;
 }
 
 /**
  * @brief 初始化HTTP客户端
  */
-int http_client_init(http_mode_t mode, uint8_t uart_num)
+int http_client_init(http_mode_t mode, uint8_t uart_num, uint32_t *baudrate)
 {
     g_http_mode = mode;
     g_uart_num = uart_num;
     
-    if (mode == HTTP_MODE_AT_COMMAND) {
+    if (mode == HTTP_MODE_AT_COMMAND || mode == HTTP_MODE_AT_PASSTHROUGH) {
+        at_engine_init(uart_num);
+        
         // 初始化WiFi模块（ESP8266示例）
         delay_ms(1000);  // 等待模块就绪
         
-        // 测试AT命令
-        if (at_send_command("AT", "OK", 2000) != 0) {
+        // 握手并提升波特率
+        uint32_t rate = at_negotiate_baudrate(baudrate ? *baudrate : 0);
+        if (baudrate) {
+            *baudrate = rate;
+        }
+        if (rate == 0) {
             return -1;
         }
         
-        // 设置为透传模式（可选）
-        // at_send_command("AT+CIPMODE=1", "OK", 2000);
-        
-        return 0;
+        // 透传模式在每次连接建立后再进入（AT+CIPMODE=1），这里保持普通模式
+        return at_engine_exec("AT+CIPMODE=0", "OK", 2000);
     }
     
     // TCP直接模式需要初始化lwIP等
     return 0;
 }
 
+/**
+ * @brief 切换后续连接使用的工作模式
+ */
+int http_client_set_mode(http_mode_t mode)
+{
+    if (mode == HTTP_MODE_TCP_DIRECT || g_http_mode == HTTP_MODE_TCP_DIRECT) {
+        return (mode == g_http_mode) ? 0 : -1;  // 需要重新初始化
+    }
+    
+    g_http_mode = mode;
+    return 0;
+}
+
 /**
  * @brief 解析URL
  */
@@ -143,12 +291,251 @@ int http_parse_url(const char *url, char *hostname, char *path, uint16_t *port)
     return 0;
 }
 
+// HTTP响应接收上下文（AT命令模式）
+typedef struct {
+    http_header_cb header_cb;
+    http_data_cb data_cb;
+    void *ctx;
+    void (*progress_cb)(uint32_t downloaded, uint32_t total);
+    http_header_parser_t parser;
+    http_chunk_decoder_t chunk;
+    http_response_t *resp;
+    uint32_t received;           // 已接收的响应体字节数
+    bool header_received;
+    bool complete;
+    bool aborted;
+} http_at_response_t;
+
+/**
+ * @brief 响应头解析完成：非2xx响应在写入任何响应体之前被拒绝
+ * @return 0继续接收响应体，-1中止
+ */
+static int http_at_headers_complete(http_at_response_t *at_resp)
+{
+    const http_response_t *resp = at_resp->resp;
+    
+    if (http_status_is_redirect(resp->status_code) && resp->location[0] != '\0') {
+        // 重定向：不接收响应体，由调用者跟随Location
+        at_resp->complete = true;
+        return 0;
+    }
+    
+    if (!http_status_is_success(resp->status_code)) {
+        return -1;
+    }
+    
+    // 分块传输的响应同样先交给调用者确认（如续传时检查206和Content-Range）
+    if (at_resp->header_cb && at_resp->header_cb(resp, at_resp->ctx) != 0) {
+        return -1;
+    }
+    
+    if (resp->chunked) {
+        // 分块传输时忽略Content-Length，以结束块判断完成
+        http_chunk_decoder_init(&at_resp->chunk);
+        return 0;
+    }
+    
+    if (resp->has_content_length && resp->content_length == 0) {
+        at_resp->complete = true;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief 响应体数据：整段直接交给调用者处理
+ */
+static int http_at_body_callback(const uint8_t *data, uint32_t len, void *ctx)
+{
+    http_at_response_t *at_resp = (http_at_response_t *)ctx;
+    const http_response_t *resp = at_resp->resp;
+    
+    if (at_resp->data_cb(data, len, at_resp->ctx) != 0) {
+        at_resp->aborted = true;
+        return -1;
+    }
+    at_resp->received += len;
+    
+    if (at_resp->progress_cb && !resp->chunked && resp->content_length > 0) {
+        at_resp->progress_cb(at_resp->received, resp->content_length);
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief +IPD载荷回调：解析响应头，响应体直接交给调用者
+ */
+static int http_at_payload_callback(const uint8_t *data, uint32_t len, void *ctx)
+{
+    http_at_response_t *at_resp = (http_at_response_t *)ctx;
+    const http_response_t *resp = at_resp->resp;
+    
+    if (at_resp->complete) {
+        return 0;
+    }
+    
+    // 解析HTTP响应头
+    if (!at_resp->header_received) {
+        uint32_t consumed = 0;
+        int ret = http_header_parse(&at_resp->parser, data, len, &consumed);
+        
+        if (ret == HTTP_PARSE_ERROR) {
+            at_resp->aborted = true;
+            return -1;
+        }
+        
+        data += consumed;
+        len -= consumed;
+        
+        if (ret == HTTP_PARSE_NEED_MORE) {
+            return 0;
+        }
+        
+        at_resp->header_received = true;
+        if (http_at_headers_complete(at_resp) != 0) {
+            at_resp->aborted = true;
+            return -1;
+        }
+    }
+    
+    if (len == 0 || at_resp->complete) {
+        return 0;
+    }
+    
+    if (resp->chunked) {
+        // 分块数据经解码器直接交给调用者，不重新缓存
+        uint32_t consumed = 0;
+        int ret = http_chunk_decode(&at_resp->chunk, data, len,
+                                    http_at_body_callback, at_resp, &consumed);
+        if (ret == HTTP_PARSE_ERROR) {
+            at_resp->aborted = true;
+            return -1;
+        }
+        if (ret == HTTP_PARSE_DONE) {
+            at_resp->complete = true;
+        }
+        return 0;
+    }
+    
+    // 如果知道内容长度，忽略多余的数据
+    if (resp->has_content_length && at_resp->received + len > resp->content_length) {
+        len = resp->content_length - at_resp->received;
+    }
+    
+    if (http_at_body_callback(data, len, at_resp) != 0) {
+        return -1;
+    }
+    
+    // 如果知道内容长度，检查是否接收完成
+    if (resp->has_content_length && at_resp->received >= resp->content_length) {
+        at_resp->complete = true;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief 构造HTTP GET请求
+ * @return 0成功，-1请求过长
+ */
+static int http_build_request(char *buf, uint32_t size, const char *hostname,
+                              const char *path, const http_request_t *request)
+{
+    int len = snprintf(buf, size,
+                       "GET %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "Connection: close\r\n", path, hostname);
+    
+    // 断点续传：请求剩余部分，ETag不匹配时服务器返回完整内容
+    if (request && request->range_start > 0 && len < (int)size) {
+        len += snprintf(buf + len, size - len,
+                        "Range: bytes=%lu-\r\n", (unsigned long)request->range_start);
+    }
+    if (request && request->if_range && len < (int)size) {
+        len += snprintf(buf + len, size - len, "If-Range: %s\r\n", request->if_range);
+    }
+    if (len < (int)size) {
+        len += snprintf(buf + len, size - len, "\r\n");
+    }
+    
+    return (len < (int)size) ? 0 : -1;
+}
+
+/**
+ * @brief 初始化响应接收上下文
+ */
+static void http_at_response_init(http_at_response_t *at_resp,
+                                  http_response_t *resp,
+                                  http_header_cb header_cb,
+                                  http_data_cb data_cb,
+                                  void *ctx,
+                                  void (*progress_cb)(uint32_t downloaded, uint32_t total))
+{
+    memset(at_resp, 0, sizeof(*at_resp));
+    at_resp->header_cb = header_cb;
+    at_resp->data_cb = data_cb;
+    at_resp->ctx = ctx;
+    at_resp->progress_cb = progress_cb;
+    at_resp->resp = resp;
+    http_header_parser_init(&at_resp->parser, resp);
+}
+
+/**
+ * @brief 检查响应是否完整接收
+ * @param closed 连接已关闭（长度未知的响应体以关闭连接结束）
+ * @return 0成功，-1失败
+ */
+static int http_at_response_finish(const http_at_response_t *at_resp, bool closed)
+{
+    const http_response_t *resp = at_resp->resp;
+    
+    if (at_resp->aborted || !at_resp->header_received) {
+        return -1;
+    }
+    
+    if (http_status_is_redirect(resp->status_code)) {
+        return 0;
+    }
+    
+    // 响应体不完整（连接提前关闭或超时）
+    if (resp->chunked) {
+        if (!at_resp->complete) {
+            return -1;
+        }
+    } else if (resp->has_content_length) {
+        if (at_resp->received != resp->content_length) {
+            return -1;
+        }
+    } else if (!closed) {
+        return -1;
+    }
+    
+    return (at_resp->received > 0) ? 0 : -1;
+}
+
+/**
+ * @brief 读取UART接收溢出计数（环形缓冲区覆盖和USART硬件溢出）
+ */
+static uint32_t http_rx_overruns(void)
+{
+    uart_stats_t stats;
+    
+    if (uart_get_stats(g_uart_num, &stats) != 0) {
+        return 0;
+    }
+    return stats.rx_overruns + stats.hw_overruns;
+}
+
 /**
  * @brief 从URL下载数据（AT命令模式）
  */
 static int http_download_at_mode(const char *url,
-                                 uint8_t *buffer,
-                                 uint32_t buffer_size,
+                                 const http_request_t *request,
+                                 http_response_t *resp,
+                                 http_header_cb header_cb,
+                                 http_data_cb data_cb,
+                                 void *ctx,
                                  uint32_t *downloaded_size,
                                  void (*progress_cb)(uint32_t downloaded, uint32_t total))
 {
@@ -160,93 +547,211 @@ static int http_download_at_mode(const char *url,
         return -1;
     }
     
+    // 构造HTTP GET请求
+    char http_request[512];
+    if (http_build_request(http_request, sizeof(http_request), hostname, path, request) != 0) {
+        return -1;
+    }
+    
     // 建立TCP连接
     char cmd[128];
     snprintf(cmd, sizeof(cmd), "AT+CIPSTART=\"TCP\",\"%s\",%d", hostname, port);
-    if (at_send_command(cmd, "OK", 10000) != 0) {
+    if (at_engine_exec(cmd, "OK", 10000) != 0) {
         return -1;
     }
     
-    delay_ms(500);
-    
-    // 发送HTTP GET请求
-    char http_request[512];
-    snprintf(http_request, sizeof(http_request),
-             "GET %s HTTP/1.1\r\n"
-             "Host: %s\r\n"
-             "Connection: close\r\n"
-             "\r\n", path, hostname);
-    
     // 设置发送长度
     snprintf(cmd, sizeof(cmd), "AT+CIPSEND=%d", (int)strlen(http_request));
-    if (at_send_command(cmd, ">", 2000) != 0) {
+    if (at_engine_exec(cmd, ">", 2000) != 0) {
         return -1;
     }
     
-    // 发送HTTP请求
+    // 发送HTTP请求（随后的"Recv N bytes"/"SEND OK"由+IPD解析器跳过）
     uart_send_string(g_uart_num, http_request);
     
-    delay_ms(1000);
+    // 接收HTTP响应（剥离+IPD帧头后交给响应解析）
+    http_at_response_t at_resp;
+    http_at_response_init(&at_resp, resp, header_cb, data_cb, ctx, progress_cb);
     
-    // 接收HTTP响应
-    uint32_t received = 0;
-    bool header_received = false;
-    uint32_t content_length = 0;
+    ipd_parser_t ipd;
+    ipd_parser_init(&ipd);
     
+    bool aborted = false;
+    uint32_t overruns = http_rx_overruns();
     uint32_t start_time = get_system_tick();
     uint32_t timeout = 60000;  // 60秒超时
     
-    while (received < buffer_size && (get_system_tick() - start_time) < timeout) {
-        uint8_t byte;
-        if (uart_receive_byte(g_uart_num, &byte) == 0) {
-            if (!header_received) {
-                // 解析HTTP响应头
-                g_at_buffer[received % AT_BUFFER_SIZE] = byte;
-                
-                // 查找Content-Length
-                if (strstr((char *)g_at_buffer, "Content-Length:")) {
-                    const char *cl = strstr((char *)g_at_buffer, "Content-Length:");
-                    if (cl) {
-                        content_length = (uint32_t)atoi(cl + 15);
-                    }
-                }
-                
-                // 查找HTTP头结束（\r\n\r\n）
-                if (received >= 3) {
-                    if (g_at_buffer[(received - 3) % AT_BUFFER_SIZE] == '\r' &&
-                        g_at_buffer[(received - 2) % AT_BUFFER_SIZE] == '\n' &&
-                        g_at_buffer[(received - 1) % AT_BUFFER_SIZE] == '\r' &&
-                        byte == '\n') {
-                        header_received = true;
-                        received = 0;  // 重置，开始接收数据
-                        continue;
-                    }
-                }
-                received++;
-            } else {
-                // 接收数据部分
-                buffer[received++] = byte;
-                
-                if (progress_cb && content_length > 0) {
-                    progress_cb(received, content_length);
-                }
-                
-                // 如果知道内容长度，检查是否接收完成
-                if (content_length > 0 && received >= content_length) {
-                    break;
-                }
-            }
-        } else {
+    while (!at_resp.complete && !ipd.closed && (get_system_tick() - start_time) < timeout) {
+        // 取出UART中已到达的字节，批量交给帧解析器
+        uint8_t rx[128];
+        uint32_t rx_len = uart_read(g_uart_num, rx, sizeof(rx));
+        
+        if (rx_len == 0) {
             delay_ms(10);
+            continue;
+        }
+        
+        // 数据在缓冲区中被覆盖（如Flash操作期间没有读取），响应已不完整，
+        // 中止后由调用者从断点续传
+        if (http_rx_overruns() != overruns) {
+            aborted = true;
+            break;
+        }
+        
+        if (ipd_parser_feed(&ipd, rx, rx_len, http_at_payload_callback, &at_resp) != 0) {
+            aborted = true;
+            break;
         }
     }
     
-    *downloaded_size = received;
+    *downloaded_size = at_resp.received;
     
     // 关闭连接
-    at_send_command("AT+CIPCLOSE", "OK", 2000);
+    at_engine_exec("AT+CIPCLOSE", "OK", 2000);
+    
+    if (aborted) {
+        return -1;
+    }
+    
+    return http_at_response_finish(&at_resp, ipd.closed);
+}
+
+/**
+ * @brief 退出透传模式并关闭连接
+ * @note "+++"前后各需保持PASSTHROUGH_GUARD_MS静默，且"+++"不能带换行
+ */
+static void http_passthrough_exit(void)
+{
+    delay_ms(PASSTHROUGH_GUARD_MS);
+    uart_send_string(g_uart_num, "+++");
+    uart_flush(g_uart_num, 100);
+    delay_ms(PASSTHROUGH_GUARD_MS);
+    
+    at_engine_submit("AT+CIPMODE=0", "OK", 2000, NULL, NULL);
+    at_engine_submit("AT+CIPCLOSE", "OK", 2000, NULL, NULL);
+    at_engine_wait();
+}
+
+/**
+ * @brief 从URL下载数据（AT透传模式）
+ * @note 进入透传后UART上只有原始TCP数据，响应直接交给HTTP解析，没有+IPD帧头开销
+ */
+static int http_download_passthrough(const char *url,
+                                     const http_request_t *request,
+                                     http_response_t *resp,
+                                     http_header_cb header_cb,
+                                     http_data_cb data_cb,
+                                     void *ctx,
+                                     uint32_t *downloaded_size,
+                                     void (*progress_cb)(uint32_t downloaded, uint32_t total))
+{
+    char hostname[64];
+    char path[256];
+    uint16_t port;
+    
+    if (http_parse_url(url, hostname, path, &port) != 0) {
+        return -1;
+    }
+    
+    // 构造HTTP GET请求
+    char http_request[512];
+    if (http_build_request(http_request, sizeof(http_request), hostname, path, request) != 0) {
+        return -1;
+    }
+    
+    // 建立TCP连接（透传模式只支持单连接）
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "AT+CIPSTART=\"TCP\",\"%s\",%d", hostname, port);
+    if (at_engine_exec(cmd, "OK", 10000) != 0) {
+        return -1;
+    }
+    
+    // 进入透传模式（两条命令连续排队，前一条完成立即发送下一条）
+    at_engine_submit("AT+CIPMODE=1", "OK", 2000, NULL, NULL);
+    at_engine_submit("AT+CIPSEND", ">", 2000, NULL, NULL);
+    if (at_engine_wait() != 0) {
+        at_engine_submit("AT+CIPMODE=0", "OK", 2000, NULL, NULL);
+        at_engine_submit("AT+CIPCLOSE", "OK", 2000, NULL, NULL);
+        at_engine_wait();
+        return -1;
+    }
+    
+    // 发送HTTP请求
+    uart_send_string(g_uart_num, http_request);
+    
+    // 接收HTTP响应（原始字节流直接交给响应解析）
+    http_at_response_t at_resp;
+    http_at_response_init(&at_resp, resp, header_cb, data_cb, ctx, progress_cb);
+    
+    bool aborted = false;
+    bool idle = false;
+    uint32_t overruns = http_rx_overruns();
+    uint32_t start_time = get_system_tick();
+    uint32_t last_rx_time = start_time;
+    uint32_t timeout = 60000;  // 60秒超时
+    
+    while (!at_resp.complete && (get_system_tick() - start_time) < timeout) {
+        uint8_t rx[128];
+        uint32_t rx_len = uart_read(g_uart_num, rx, sizeof(rx));
+        
+        if (rx_len == 0) {
+            // 响应头之后长时间没有数据，视为服务器已关闭连接
+            if (at_resp.header_received &&
+                (get_system_tick() - last_rx_time) >= PASSTHROUGH_IDLE_MS) {
+                idle = true;
+                break;
+            }
+            delay_ms(1);
+            continue;
+        }
+        
+        last_rx_time = get_system_tick();
+        
+        // 数据被覆盖后响应已不完整（透传数据没有帧校验，只能由溢出计数发现）
+        if (http_rx_overruns() != overruns) {
+            aborted = true;
+            break;
+        }
+        
+        if (http_at_payload_callback(rx, rx_len, &at_resp) != 0) {
+            aborted = true;
+            break;
+        }
+    }
     
-    return (received > 0) ? 0 : -1;
+    *downloaded_size = at_resp.received;
+    
+    // 退出透传并关闭连接
+    http_passthrough_exit();
+    
+    if (aborted) {
+        return -1;
+    }
+    
+    return http_at_response_finish(&at_resp, idle);
+}
+
+// 缓冲区下载上下文
+typedef struct {
+    uint8_t *buffer;
+    uint32_t buffer_size;
+    uint32_t pos;
+} http_buffer_sink_t;
+
+/**
+ * @brief 把响应体写入调用者提供的缓冲区
+ */
+static int http_buffer_sink(const uint8_t *data, uint32_t len, void *ctx)
+{
+    http_buffer_sink_t *sink = (http_buffer_sink_t *)ctx;
+    
+    if (sink->pos + len > sink->buffer_size) {
+        return -1;  // 缓冲区已满
+    }
+    
+    memcpy(sink->buffer + sink->pos, data, len);
+    sink->pos += len;
+    return 0;
 }
 
 /**
@@ -262,13 +767,63 @@ int http_client_download(const char *url,
         return -1;
     }
     
-    if (g_http_mode == HTTP_MODE_AT_COMMAND) {
-        return http_download_at_mode(url, buffer, buffer_size, downloaded_size, progress_cb);
+    http_buffer_sink_t sink = { buffer, buffer_size, 0 };
+    return http_client_download_stream(url, NULL, NULL, NULL, http_buffer_sink, &sink,
+                                       downloaded_size, progress_cb);
+}
+
+/**
+ * @brief 从URL流式下载数据
+ */
+int http_client_download_stream(const char *url,
+                                const http_request_t *request,
+                                http_response_t *response,
+                                http_header_cb header_cb,
+                                http_data_cb data_cb,
+                                void *ctx,
+                                uint32_t *downloaded_size,
+                                void (*progress_cb)(uint32_t downloaded, uint32_t total))
+{
+    if (url == NULL || data_cb == NULL || downloaded_size == NULL) {
+        return -1;
+    }
+    
+    if (g_http_mode == HTTP_MODE_TCP_DIRECT) {
+        // TCP直接模式（需要lwIP实现）
+        // TODO: 实现lwIP版本
+        return -1;
     }
     
-    // TCP直接模式（需要lwIP实现）
-    // TODO: 实现lwIP版本
+    http_response_t local_resp;
+    http_response_t *resp = response ? response : &local_resp;
+    char redirect_url[HTTP_LOCATION_MAX_LEN];
     
-    return -1;
+    for (uint8_t redirects = 0; redirects <= HTTP_MAX_REDIRECTS; redirects++) {
+        int ret;
+        if (g_http_mode == HTTP_MODE_AT_PASSTHROUGH) {
+            ret = http_download_passthrough(url, request, resp, header_cb, data_cb, ctx,
+                                            downloaded_size, progress_cb);
+        } else {
+            ret = http_download_at_mode(url, request, resp, header_cb, data_cb, ctx,
+                                        downloaded_size, progress_cb);
+        }
+        if (ret != 0) {
+            return -1;
+        }
+        
+        if (!http_status_is_redirect(resp->status_code)) {
+            return 0;
+        }
+        
+        // 跟随重定向（只支持绝对URL）
+        if (strncmp(resp->location, "http://", 7) != 0 &&
+            strncmp(resp->location, "https://", 8) != 0) {
+            return -1;
+        }
+        strcpy(redirect_url, resp->location);
+        url = redirect_url;
+    }
+    
+    return -1;  // 重定向次数过多
 }
 
@@ -8,20 +8,60 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "http_parser.h"
 
 // HTTP客户端模式
 typedef enum {
-    HTTP_MODE_AT_COMMAND = 0,  // 使用AT命令（WiFi模块）
-    HTTP_MODE_TCP_DIRECT = 1   // 直接TCP（lwIP等）
+    HTTP_MODE_AT_COMMAND = 0,     // 使用AT命令（WiFi模块，数据带+IPD帧头）
+    HTTP_MODE_TCP_DIRECT = 1,     // 直接TCP（lwIP等）
+    HTTP_MODE_AT_PASSTHROUGH = 2  // AT透传模式（AT+CIPMODE=1，UART上只有原始TCP数据）
 } http_mode_t;
 
+// 请求选项
+typedef struct {
+    uint32_t range_start;        // 非0时发送"Range: bytes=<range_start>-"
+    const char *if_range;        // 非NULL时发送"If-Range: <ETag>"，资源已变化则服务器返回完整内容
+} http_request_t;
+
+/**
+ * @brief 响应头回调（2xx响应头解析完成、响应体到达之前调用）
+ * @param resp 响应信息
+ * @param ctx 用户上下文
+ * @return 0继续接收响应体，-1中止下载
+ */
+typedef int (*http_header_cb)(const http_response_t *resp, void *ctx);
+
+/**
+ * @brief 响应体数据回调（流式下载）
+ * @param data 数据指针
+ * @param len 数据长度
+ * @param ctx 用户上下文
+ * @return 0继续接收，-1中止下载
+ */
+typedef int (*http_data_cb)(const uint8_t *data, uint32_t len, void *ctx);
+
 /**
  * @brief 初始化HTTP客户端
  * @param mode 工作模式
  * @param uart_num UART编号（AT命令模式）
+ * @param baudrate 输入：上次协商成功的波特率（0表示未知），输出：当前使用的波特率（可选）
+ * @return 0成功，-1失败
+ * @note AT模式下握手成功后用AT+UART_CUR逐级尝试更高波特率（最高921600），
+ *       每一级都用往返探测确认，探测失败自动退回。没有流控时波特率不超过接收缓冲区
+ *       能容纳下载中最长停顿（同步擦除、编程Flash）的值，2KB接收缓冲区低于最低的
+ *       候选波特率，即没有流控时不协商（见config.h的WIFI_UART_FLOW_CONTROL）。
+ *       模块只在断电后恢复默认波特率，因此先用上次的波特率握手，MCU单独复位后无需重新协商。
+ *       UART已启用流控（uart_set_flow_control）时模块同时切换为RTS/CTS流控。
+ */
+int http_client_init(http_mode_t mode, uint8_t uart_num, uint32_t *baudrate);
+
+/**
+ * @brief 切换后续连接使用的工作模式
+ * @param mode 工作模式（AT命令模式和AT透传模式可以随时互相切换）
  * @return 0成功，-1失败
+ * @note 每次下载建立独立的TCP连接，切换在下一次连接时生效
  */
-int http_client_init(http_mode_t mode, uint8_t uart_num);
+int http_client_set_mode(http_mode_t mode);
 
 /**
  * @brief 从URL下载数据
@@ -38,6 +78,29 @@ int http_client_download(const char *url,
                         uint32_t *downloaded_size,
                         void (*progress_cb)(uint32_t downloaded, uint32_t total));
 
+/**
+ * @brief 从URL流式下载数据（不缓存整个响应体）
+ * @param url URL地址
+ * @param request 请求选项（可选，NULL为普通GET）
+ * @param response 响应信息（可选，输出）
+ * @param header_cb 响应头回调（可选）
+ * @param data_cb 响应体数据回调，数据到达即交给调用者
+ * @param ctx 传给header_cb和data_cb的用户上下文
+ * @param downloaded_size 实际下载大小（输出）
+ * @param progress_cb 进度回调（可选）
+ * @return 0成功，-1失败
+ * @note data_cb中同步擦除、编程Flash期间不读取UART，到达的数据超过接收缓冲区时
+ *       被覆盖；发现UART接收溢出立即中止并返回-1（已交给data_cb的数据都是完整的）
+ */
+int http_client_download_stream(const char *url,
+                                const http_request_t *request,
+                                http_response_t *response,
+                                http_header_cb header_cb,
+                                http_data_cb data_cb,
+                                void *ctx,
+                                uint32_t *downloaded_size,
+                                void (*progress_cb)(uint32_t downloaded, uint32_t total));
+
 /**
  * @brief 解析URL
  * @param url 完整URL
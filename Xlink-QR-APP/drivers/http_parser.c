@@ -0,0 +1,590 @@
+/**
+ * @file http_parser.c
+ * @brief HTTP响应流式解析实现
+ */
+
+#include "http_parser.h"
+#include <string.h>
+
+// 解析状态
+enum {
+    HP_STATUS_PROTO = 0,    // "HTTP/"
+    HP_STATUS_VERSION,      // "1.1"
+    HP_STATUS_CODE,         // "200"
+    HP_STATUS_REASON,       // "OK"
+    HP_LINE_LF,             // 行尾'\r'之后的'\n'
+    HP_LINE_START,          // 新的一行
+    HP_NAME,                // 字段名
+    HP_VALUE_LEAD,          // 字段值前的空白
+    HP_VALUE,               // 字段值
+    HP_END_LF,              // 空行'\r'之后的'\n'
+    HP_DONE
+};
+
+// 关注的响应头字段
+enum {
+    HF_NONE = 0,
+    HF_CONTENT_LENGTH,
+    HF_TRANSFER_ENCODING,
+    HF_CONTENT_RANGE,
+    HF_ETAG,
+    HF_LOCATION,
+    HF_COUNT
+};
+
+// 字段名（小写，按字段编号排列）
+static const char *const g_field_names[HF_COUNT] = {
+    "",
+    "content-length",
+    "transfer-encoding",
+    "content-range",
+    "etag",
+    "location"
+};
+
+#define HF_ALL_CANDIDATES  (((1u << HF_COUNT) - 1) & ~1u)
+
+// Content-Range解析子状态
+enum {
+    CR_UNIT = 0,    // "bytes"
+    CR_START,
+    CR_END,
+    CR_TOTAL,
+    CR_SKIP
+};
+
+// 分块传输解码状态
+enum {
+    HC_SIZE = 0,            // 分块长度（十六进制）
+    HC_SIZE_EXT,            // 分块扩展（";name=value"，忽略）
+    HC_SIZE_LF,             // 长度行'\r'之后的'\n'
+    HC_DATA,                // 分块数据
+    HC_DATA_CR,             // 数据后的'\r'
+    HC_DATA_LF,             // 数据后的'\n'
+    HC_TRAILER_START,       // 结束块之后的尾部字段行
+    HC_TRAILER_LINE,
+    HC_FINAL_LF,            // 最后空行的'\n'
+    HC_DONE
+};
+
+// 分块长度上限（十六进制位数）
+#define HC_MAX_SIZE_DIGITS  7
+
+static const char HTTP_PROTO[] = "HTTP/";
+static const char CHUNKED_TOKEN[] = "chunked";
+
+static uint8_t to_lower(uint8_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c + ('a' - 'A')) : c;
+}
+
+static bool is_digit(uint8_t c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief 初始化响应头解析器
+ */
+void http_header_parser_init(http_header_parser_t *parser, http_response_t *resp)
+{
+    memset(parser, 0, sizeof(*parser));
+    memset(resp, 0, sizeof(*resp));
+    parser->state = HP_STATUS_PROTO;
+    parser->resp = resp;
+}
+
+/**
+ * @brief 字段名：与所有候选字段逐字符比较（候选数固定，每字节O(1)）
+ */
+static void header_name_byte(http_header_parser_t *parser, uint8_t c)
+{
+    c = to_lower(c);
+    
+    for (uint8_t f = 1; f < HF_COUNT; f++) {
+        if ((parser->candidates & (1u << f)) &&
+            (uint8_t)g_field_names[f][parser->pos] != c) {
+            parser->candidates &= (uint8_t)~(1u << f);
+        }
+    }
+    parser->pos++;
+}
+
+/**
+ * @brief 字段名结束：确定是哪个字段
+ */
+static void header_name_end(http_header_parser_t *parser)
+{
+    parser->field = HF_NONE;
+    
+    for (uint8_t f = 1; f < HF_COUNT; f++) {
+        if ((parser->candidates & (1u << f)) &&
+            g_field_names[f][parser->pos] == '\0') {
+            parser->field = f;
+            break;
+        }
+    }
+    
+    parser->pos = 0;
+    parser->sub = 0;
+    parser->value_len = 0;
+    
+    if (parser->field == HF_CONTENT_LENGTH) {
+        parser->resp->has_content_length = true;
+        parser->resp->content_length = 0;
+    }
+}
+
+/**
+ * @brief 保存字符串字段值（ETag/Location），超长时作废
+ */
+static void value_store_byte(http_header_parser_t *parser, char *dst, uint16_t max, uint8_t c)
+{
+    if (parser->sub) {
+        return;  // 已超长
+    }
+    
+    if (parser->pos >= max - 1) {
+        parser->sub = 1;
+        return;
+    }
+    
+    dst[parser->pos++] = (char)c;
+    if (c != ' ' && c != '\t') {
+        parser->value_len = parser->pos;
+    }
+}
+
+static void value_store_end(http_header_parser_t *parser, char *dst)
+{
+    dst[parser->sub ? 0 : parser->value_len] = '\0';
+}
+
+/**
+ * @brief 十进制数字累加（带溢出检查）
+ */
+static int accumulate_digit(uint32_t *value, uint8_t c)
+{
+    uint32_t digit = (uint32_t)(c - '0');
+    if (*value > (0xFFFFFFFFu - digit) / 10) {
+        return -1;
+    }
+    *value = *value * 10 + digit;
+    return 0;
+}
+
+/**
+ * @brief Content-Range: bytes <start>-<end>/<total|*>
+ */
+static int content_range_byte(http_header_parser_t *parser, uint8_t c)
+{
+    http_response_t *resp = parser->resp;
+    
+    switch (parser->sub) {
+        case CR_UNIT:
+            if (c == ' ') {
+                parser->sub = CR_START;
+                resp->range_start = 0;
+                resp->range_end = 0;
+                resp->range_total = 0;
+            }
+            return 0;
+            
+        case CR_START:
+            if (is_digit(c)) {
+                return accumulate_digit(&resp->range_start, c);
+            }
+            if (c == '-') {
+                parser->sub = CR_END;
+                return 0;
+            }
+            if (c == '*') {
+                parser->sub = CR_SKIP;  // 范围不可满足
+                return 0;
+            }
+            return (c == ' ') ? 0 : -1;
+            
+        case CR_END:
+            if (is_digit(c)) {
+                return accumulate_digit(&resp->range_end, c);
+            }
+            if (c == '/') {
+                parser->sub = CR_TOTAL;
+                resp->has_content_range = true;
+                return 0;
+            }
+            return -1;
+            
+        case CR_TOTAL:
+            if (is_digit(c)) {
+                return accumulate_digit(&resp->range_total, c);
+            }
+            if (c == '*') {
+                resp->range_total = 0;  // 总长度未知
+                return 0;
+            }
+            return (c == ' ' || c == '\t') ? 0 : -1;
+            
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 字段值字节
+ */
+static int header_value_byte(http_header_parser_t *parser, uint8_t c)
+{
+    http_response_t *resp = parser->resp;
+    
+    switch (parser->field) {
+        case HF_CONTENT_LENGTH:
+            if (is_digit(c)) {
+                return accumulate_digit(&resp->content_length, c);
+            }
+            return (c == ' ' || c == '\t') ? 0 : -1;
+            
+        case HF_TRANSFER_ENCODING:
+            // 在字段值中查找"chunked"（无自重叠前缀，失配时只检查首字符）
+            c = to_lower(c);
+            if (c == (uint8_t)CHUNKED_TOKEN[parser->pos]) {
+                parser->pos++;
+                if (CHUNKED_TOKEN[parser->pos] == '\0') {
+                    resp->chunked = true;
+                    parser->pos = 0;
+                }
+            } else {
+                parser->pos = (c == (uint8_t)CHUNKED_TOKEN[0]) ? 1 : 0;
+            }
+            return 0;
+            
+        case HF_CONTENT_RANGE:
+            return content_range_byte(parser, c);
+            
+        case HF_ETAG:
+            value_store_byte(parser, resp->etag, HTTP_ETAG_MAX_LEN, c);
+            return 0;
+            
+        case HF_LOCATION:
+            value_store_byte(parser, resp->location, HTTP_LOCATION_MAX_LEN, c);
+            return 0;
+            
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 字段值结束
+ */
+static void header_value_end(http_header_parser_t *parser)
+{
+    if (parser->field == HF_ETAG) {
+        value_store_end(parser, parser->resp->etag);
+    } else if (parser->field == HF_LOCATION) {
+        value_store_end(parser, parser->resp->location);
+    }
+    parser->field = HF_NONE;
+}
+
+/**
+ * @brief 处理一个字节
+ * @return 0继续，-1格式错误
+ */
+static int header_parse_byte(http_header_parser_t *parser, uint8_t c)
+{
+    http_response_t *resp = parser->resp;
+    
+    switch (parser->state) {
+        case HP_STATUS_PROTO:
+            if (c != (uint8_t)HTTP_PROTO[parser->pos]) {
+                return -1;
+            }
+            if (HTTP_PROTO[++parser->pos] == '\0') {
+                parser->pos = 0;
+                parser->state = HP_STATUS_VERSION;
+            }
+            return 0;
+            
+        case HP_STATUS_VERSION:
+            if (c == ' ') {
+                parser->state = HP_STATUS_CODE;
+            } else if (c == '\r' || c == '\n') {
+                return -1;
+            }
+            return 0;
+            
+        case HP_STATUS_CODE:
+            if (is_digit(c) && parser->pos < 3) {
+                resp->status_code = (uint16_t)(resp->status_code * 10 + (c - '0'));
+                parser->pos++;
+                return 0;
+            }
+            if (parser->pos != 3) {
+                return -1;
+            }
+            parser->pos = 0;
+            if (c == ' ') {
+                parser->state = HP_STATUS_REASON;
+            } else if (c == '\r') {
+                parser->state = HP_LINE_LF;
+            } else if (c == '\n') {
+                parser->state = HP_LINE_START;
+            } else {
+                return -1;
+            }
+            return 0;
+            
+        case HP_STATUS_REASON:
+            if (c == '\r') {
+                parser->state = HP_LINE_LF;
+            } else if (c == '\n') {
+                parser->state = HP_LINE_START;
+            }
+            return 0;
+            
+        case HP_LINE_LF:
+            if (c != '\n') {
+                return -1;
+            }
+            parser->state = HP_LINE_START;
+            return 0;
+            
+        case HP_LINE_START:
+            if (c == '\r') {
+                parser->state = HP_END_LF;
+                return 0;
+            }
+            if (c == '\n') {
+                parser->state = HP_DONE;
+                return 0;
+            }
+            parser->candidates = HF_ALL_CANDIDATES;
+            parser->pos = 0;
+            parser->state = HP_NAME;
+            // 当前字节属于字段名
+            // fall through
+            
+        case HP_NAME:
+            if (c == ':') {
+                header_name_end(parser);
+                parser->state = HP_VALUE_LEAD;
+            } else if (c == '\r' || c == '\n') {
+                return -1;
+            } else {
+                header_name_byte(parser, c);
+            }
+            return 0;
+            
+        case HP_VALUE_LEAD:
+            if (c == ' ' || c == '\t') {
+                return 0;
+            }
+            parser->state = HP_VALUE;
+            // 当前字节属于字段值
+            // fall through
+            
+        case HP_VALUE:
+            if (c == '\r' || c == '\n') {
+                header_value_end(parser);
+                parser->state = (c == '\r') ? HP_LINE_LF : HP_LINE_START;
+                return 0;
+            }
+            return header_value_byte(parser, c);
+            
+        case HP_END_LF:
+            if (c != '\n') {
+                return -1;
+            }
+            parser->state = HP_DONE;
+            return 0;
+            
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 输入响应数据
+ */
+int http_header_parse(http_header_parser_t *parser, const uint8_t *data,
+                      uint32_t len, uint32_t *consumed)
+{
+    uint32_t i = 0;
+    
+    while (i < len && parser->state != HP_DONE) {
+        if (++parser->total > HTTP_MAX_HEADER_SIZE) {
+            *consumed = i;
+            return HTTP_PARSE_ERROR;
+        }
+        
+        if (header_parse_byte(parser, data[i++]) != 0) {
+            *consumed = i;
+            return HTTP_PARSE_ERROR;
+        }
+    }
+    
+    *consumed = i;
+    return (parser->state == HP_DONE) ? HTTP_PARSE_DONE : HTTP_PARSE_NEED_MORE;
+}
+
+/**
+ * @brief 初始化分块传输解码器
+ */
+void http_chunk_decoder_init(http_chunk_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->state = HC_SIZE;
+}
+
+/**
+ * @brief 十六进制字符转数值
+ * @return 0-15，非十六进制字符返回-1
+ */
+static int hex_value(uint8_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = to_lower(c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief 分块控制字节（长度行、分隔符、尾部字段）
+ * @return 0继续，-1格式错误
+ */
+static int chunk_control_byte(http_chunk_decoder_t *decoder, uint8_t c)
+{
+    switch (decoder->state) {
+        case HC_SIZE: {
+            int v = hex_value(c);
+            if (v >= 0) {
+                if (++decoder->digits > HC_MAX_SIZE_DIGITS) {
+                    return -1;
+                }
+                decoder->chunk_remaining = (decoder->chunk_remaining << 4) | (uint32_t)v;
+                return 0;
+            }
+            if (decoder->digits == 0) {
+                return -1;
+            }
+            if (c == ';' || c == ' ' || c == '\t') {
+                decoder->state = HC_SIZE_EXT;
+            } else if (c == '\r') {
+                decoder->state = HC_SIZE_LF;
+            } else {
+                return -1;
+            }
+            return 0;
+        }
+            
+        case HC_SIZE_EXT:
+            if (c == '\r') {
+                decoder->state = HC_SIZE_LF;
+            }
+            return 0;
+            
+        case HC_SIZE_LF:
+            if (c != '\n') {
+                return -1;
+            }
+            decoder->digits = 0;
+            decoder->state = (decoder->chunk_remaining > 0) ? HC_DATA : HC_TRAILER_START;
+            return 0;
+            
+        case HC_DATA_CR:
+            if (c != '\r') {
+                return -1;
+            }
+            decoder->state = HC_DATA_LF;
+            return 0;
+            
+        case HC_DATA_LF:
+            if (c != '\n') {
+                return -1;
+            }
+            decoder->state = HC_SIZE;
+            return 0;
+            
+        case HC_TRAILER_START:
+            decoder->state = (c == '\r') ? HC_FINAL_LF : HC_TRAILER_LINE;
+            return 0;
+            
+        case HC_TRAILER_LINE:
+            if (c == '\n') {
+                decoder->state = HC_TRAILER_START;
+            }
+            return 0;
+            
+        case HC_FINAL_LF:
+            if (c != '\n') {
+                return -1;
+            }
+            decoder->state = HC_DONE;
+            return 0;
+            
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief 输入分块编码的响应体
+ */
+int http_chunk_decode(http_chunk_decoder_t *decoder, const uint8_t *data, uint32_t len,
+                      http_chunk_data_cb data_cb, void *ctx, uint32_t *consumed)
+{
+    uint32_t i = 0;
+    
+    while (i < len && decoder->state != HC_DONE) {
+        if (decoder->state == HC_DATA) {
+            // 分块数据整段交给回调
+            uint32_t n = len - i;
+            if (n > decoder->chunk_remaining) {
+                n = decoder->chunk_remaining;
+            }
+            
+            if (data_cb && data_cb(&data[i], n, ctx) != 0) {
+                *consumed = i;
+                return HTTP_PARSE_ERROR;
+            }
+            
+            i += n;
+            decoder->decoded += n;
+            decoder->chunk_remaining -= n;
+            if (decoder->chunk_remaining == 0) {
+                decoder->state = HC_DATA_CR;
+            }
+            continue;
+        }
+        
+        if (chunk_control_byte(decoder, data[i++]) != 0) {
+            *consumed = i;
+            return HTTP_PARSE_ERROR;
+        }
+    }
+    
+    *consumed = i;
+    return (decoder->state == HC_DONE) ? HTTP_PARSE_DONE : HTTP_PARSE_NEED_MORE;
+}
+
+/**
+ * @brief 判断状态码是否为2xx
+ */
+bool http_status_is_success(uint16_t status_code)
+{
+    return status_code >= 200 && status_code < 300;
+}
+
+/**
+ * @brief 判断状态码是否为重定向
+ */
+bool http_status_is_redirect(uint16_t status_code)
+{
+    return status_code == 301 || status_code == 302 || status_code == 303 ||
+           status_code == 307 || status_code == 308;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file http_parser.h
+ * @brief HTTP响应流式解析器
+ * @note 逐字节解析响应头，每字节O(1)开销，不缓存响应头文本，
+ *       只保存需要的字段值。
+ */
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HTTP_ETAG_MAX_LEN        48    // ETag最大长度（含结束符）
+#define HTTP_LOCATION_MAX_LEN    128   // Location最大长度（含结束符）
+#define HTTP_MAX_HEADER_SIZE     4096  // 响应头最大总长度
+
+// 解析结果
+#define HTTP_PARSE_NEED_MORE     0     // 响应头未结束
+#define HTTP_PARSE_DONE          1     // 响应头解析完成
+#define HTTP_PARSE_ERROR         (-1)  // 响应格式错误
+
+// 响应信息（从响应头中提取）
+typedef struct {
+    uint16_t status_code;                   // 状态码
+    bool has_content_length;
+    uint32_t content_length;                // Content-Length
+    bool chunked;                           // Transfer-Encoding: chunked
+    bool has_content_range;
+    uint32_t range_start;                   // Content-Range起始字节
+    uint32_t range_end;                     // Content-Range结束字节（含）
+    uint32_t range_total;                   // Content-Range总长度（未知为0）
+    char etag[HTTP_ETAG_MAX_LEN];           // ETag（超长时为空）
+    char location[HTTP_LOCATION_MAX_LEN];   // Location（超长时为空）
+} http_response_t;
+
+// 响应头解析器上下文
+typedef struct {
+    uint8_t state;              // 解析状态
+    uint8_t field;              // 当前头字段
+    uint8_t candidates;         // 仍可能匹配的已知字段（位掩码）
+    uint8_t sub;                // 字段值内部状态
+    uint16_t pos;               // 当前字段名/值位置
+    uint16_t value_len;         // 已保存的字段值长度（去除尾部空白）
+    uint32_t total;             // 已解析的响应头字节数
+    http_response_t *resp;      // 输出
+} http_header_parser_t;
+
+// 分块传输解码器上下文（固定大小，不缓存分块数据）
+typedef struct {
+    uint8_t state;              // 解码状态
+    uint8_t digits;             // 当前分块长度的十六进制位数
+    uint32_t chunk_remaining;   // 当前分块剩余字节数
+    uint32_t decoded;           // 已解码的数据字节数
+} http_chunk_decoder_t;
+
+/**
+ * @brief 解码数据回调
+ * @param data 数据片段（指向输入数据）
+ * @param len 片段长度
+ * @param ctx 用户上下文
+ * @return 0继续，-1中止
+ */
+typedef int (*http_chunk_data_cb)(const uint8_t *data, uint32_t len, void *ctx);
+
+/**
+ * @brief 初始化响应头解析器
+ * @param parser 解析器上下文
+ * @param resp 输出的响应信息（会被清零）
+ */
+void http_header_parser_init(http_header_parser_t *parser, http_response_t *resp);
+
+/**
+ * @brief 输入响应数据
+ * @param parser 解析器上下文
+ * @param data 数据
+ * @param len 数据长度
+ * @param consumed 本次消耗的字节数（输出），响应头结束后剩余数据为响应体
+ * @return HTTP_PARSE_NEED_MORE / HTTP_PARSE_DONE / HTTP_PARSE_ERROR
+ */
+int http_header_parse(http_header_parser_t *parser, const uint8_t *data,
+                      uint32_t len, uint32_t *consumed);
+
+/**
+ * @brief 初始化分块传输解码器
+ * @param decoder 解码器上下文
+ */
+void http_chunk_decoder_init(http_chunk_decoder_t *decoder);
+
+/**
+ * @brief 输入分块编码的响应体
+ * @note 分块数据以输入数据片段的形式直接交给回调，分块可以在任意位置被切断
+ * @param decoder 解码器上下文
+ * @param data 数据
+ * @param len 数据长度
+ * @param data_cb 解码数据回调
+ * @param ctx 传给data_cb的用户上下文
+ * @param consumed 本次消耗的字节数（输出），结束块之后的数据不消耗
+ * @return HTTP_PARSE_NEED_MORE / HTTP_PARSE_DONE（收到结束块） / HTTP_PARSE_ERROR
+ */
+int http_chunk_decode(http_chunk_decoder_t *decoder, const uint8_t *data, uint32_t len,
+                      http_chunk_data_cb data_cb, void *ctx, uint32_t *consumed);
+
+/**
+ * @brief 判断状态码是否为2xx
+ */
+bool http_status_is_success(uint16_t status_code);
+
+/**
+ * @brief 判断状态码是否为重定向（301/302/303/307/308）
+ */
+bool http_status_is_redirect(uint16_t status_code);
+
+#endif // HTTP_PARSER_H
@@ -42,7 +42,7 @@ extern GPIO_TypeDef* GPIOC;
 
 // ==================== Flash操作实现 ====================
 
-void flash_unlock(void)
+RAMFUNC void flash_unlock(void)
 {
 #ifdef USE_HAL_DRIVER
     HAL_FLASH_Unlock();
@@ -53,7 +53,7 @@ void flash_unlock(void)
 #endif
 }
 
-void flash_lock(void)
+RAMFUNC void flash_lock(void)
 {
 #ifdef USE_HAL_DRIVER
     HAL_FLASH_Lock();
@@ -63,86 +63,91 @@ void flash_lock(void)
 #endif
 }
 
-int flash_erase_page(uint32_t page_addr)
+RAMFUNC int flash_erase_page(uint32_t page_addr)
 {
-#ifdef USE_HAL_DRIVER
-    FLASH_EraseInitTypeDef EraseInitStruct;
-    uint32_t PageError = 0;
-    
-    EraseInitStruct.TypeErase = FLASH_TYPEERASE_PAGES;
-    EraseInitStruct.PageAddress = page_addr;
-    EraseInitStruct.NbPages = 1;
-    
-    if (HAL_FLASHEx_Erase(&EraseInitStruct, &PageError) == HAL_OK) {
-        return 0;
-    }
-    return -1;
-#else
-    // 标准外设库方式
-    // 等待Flash空闲
+    // 直接操作寄存器并在RAM中等待完成（HAL库的擦除函数在Flash中执行）
     while (FLASH->SR & FLASH_SR_BSY);
     
-    // 检查是否已解锁
     if (FLASH->CR & FLASH_CR_LOCK) {
         flash_unlock();
     }
     
-    // 设置页擦除
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
     FLASH->CR |= FLASH_CR_PER;
     FLASH->AR = page_addr;
     FLASH->CR |= FLASH_CR_STRT;
     
-    // 等待完成
     while (FLASH->SR & FLASH_SR_BSY);
     
-    // 清除标志
-    if (FLASH->SR & FLASH_SR_EOP) {
-        FLASH->SR = FLASH_SR_EOP;
-    }
+    int ret = (FLASH->SR & FLASH_SR_WRPRTERR) ? -1 : 0;
     
-    // 清除PER位
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
     FLASH->CR &= ~FLASH_CR_PER;
     
-    return 0;
-#endif
+    return ret;
 }
 
-int flash_program_word(uint32_t addr, uint32_t data)
+RAMFUNC int flash_program_word(uint32_t addr, uint32_t data)
 {
-#ifdef USE_HAL_DRIVER
-    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, data) == HAL_OK) {
-        return 0;
+    if ((addr & 3) != 0) {
+        return -1;
     }
-    return -1;
-#else
-    // 标准外设库方式
-    // 等待Flash空闲
+    
+    // 按两个半字编程（低半字在前），在RAM中等待每次编程完成
+    return flash_program_buffer(addr, (const uint8_t *)&data, sizeof(data), NULL);
+}
+
+RAMFUNC int flash_program_buffer(uint32_t addr, const uint8_t *data, uint32_t len, uint32_t *fail_addr)
+{
+    if (data == NULL || (addr & 1) != 0) {
+        if (fail_addr) {
+            *fail_addr = addr;
+        }
+        return -1;
+    }
+    
+    // 半字编程直接操作寄存器（HAL库每个半字都会重新设置和清除PG位）
     while (FLASH->SR & FLASH_SR_BSY);
     
-    // 检查是否已解锁
     if (FLASH->CR & FLASH_CR_LOCK) {
         flash_unlock();
     }
     
-    // 设置编程位
+    // 清除上次残留的错误标志
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
     FLASH->CR |= FLASH_CR_PG;
     
-    // 写入数据
-    *(volatile uint32_t *)addr = data;
-    
-    // 等待完成
-    while (FLASH->SR & FLASH_SR_BSY);
-    
-    // 清除标志
-    if (FLASH->SR & FLASH_SR_EOP) {
-        FLASH->SR = FLASH_SR_EOP;
+    int ret = 0;
+    for (uint32_t i = 0; i < len; i += 2) {
+        uint16_t halfword = data[i];
+        halfword |= (i + 1 < len) ? ((uint16_t)data[i + 1] << 8) : 0xFF00;
+        
+        // 与现有内容相同，无需编程
+        volatile uint16_t *dest = (volatile uint16_t *)(addr + i);
+        if (*dest == halfword) {
+            continue;
+        }
+        
+        // 0xFFFF不需要编程，但Flash不是空白时与数据不符，同样按失败处理
+        if (halfword != 0xFFFF) {
+            *dest = halfword;
+            while (FLASH->SR & FLASH_SR_BSY);
+        }
+        
+        if ((FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) || *dest != halfword) {
+            FLASH->SR = FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+            if (fail_addr) {
+                *fail_addr = addr + i;
+            }
+            ret = -1;
+            break;
+        }
     }
     
-    // 清除PG位
+    FLASH->SR = FLASH_SR_EOP;
     FLASH->CR &= ~FLASH_CR_PG;
     
-    return 0;
-#endif
+    return ret;
 }
 
 // ==================== UART操作实现 ====================
@@ -150,12 +155,249 @@ int flash_program_word(uint32_t addr, uint32_t data)
 // UART句柄数组
 static void *g_uart_handles[3] = {NULL, NULL, NULL};
 
+// UART接收环形缓冲区（DMA循环写入，head/tail为累计字节数）
+typedef struct {
+    uint8_t *buffer;
+    uint16_t size;
+    uint16_t dma_pos;                // 上次观察到的DMA写入位置
+    volatile uint32_t head;          // 已接收字节总数
+    volatile uint32_t tail;          // 已读取字节总数
+    uint32_t rx_overruns;            // 被覆盖丢弃的字节数
+    uint32_t hw_overruns;            // USART ORE次数
+    USART_TypeDef *usart;
+    DMA_Channel_TypeDef *dma;
+    uint8_t dma_channel;             // DMA1通道号（用于清除中断标志）
+    GPIO_TypeDef *rts_port;          // 软件RTS引脚（NULL表示未启用流控）
+    uint16_t rts_pin;
+} uart_rx_t;
+
+static uint8_t g_uart1_rx_buffer[UART1_RX_BUFFER_SIZE];
+static uint8_t g_uart2_rx_buffer[UART2_RX_BUFFER_SIZE];
+static uint8_t g_uart3_rx_buffer[UART3_RX_BUFFER_SIZE];
+
+static uart_rx_t g_uart_rx[3];
+
+// UART发送环形缓冲区（head/tail为累计字节数，DMA每次发送一段连续区域）
+typedef struct {
+    uint8_t *buffer;
+    uint16_t size;
+    volatile uint16_t dma_len;       // 正在发送的字节数（0表示DMA空闲）
+    volatile uint32_t head;          // 已排队字节总数
+    volatile uint32_t tail;          // 已发送字节总数
+    USART_TypeDef *usart;
+    DMA_Channel_TypeDef *dma;
+    uint8_t dma_channel;
+    uart_tx_complete_cb callback;
+    void *callback_ctx;
+} uart_tx_t;
+
+static uint8_t g_uart1_tx_buffer[UART1_TX_BUFFER_SIZE];
+static uint8_t g_uart2_tx_buffer[UART2_TX_BUFFER_SIZE];
+static uint8_t g_uart3_tx_buffer[UART3_TX_BUFFER_SIZE];
+
+static uart_tx_t g_uart_tx[3];
+
+/**
+ * @brief 获取UART接收缓冲区（未初始化返回NULL）
+ */
+RAMFUNC static uart_rx_t *uart_rx_get(uint8_t uart_num)
+{
+    if (uart_num < 1 || uart_num > 3 || g_uart_rx[uart_num - 1].buffer == NULL) {
+        return NULL;
+    }
+    return &g_uart_rx[uart_num - 1];
+}
+
+/**
+ * @brief 按接收缓冲区使用量控制RTS（调用者需关中断或在中断中调用）
+ * @note 两次更新之间DMA最多前进半圈，使用量超过半圈（减去对方响应RTS前
+ *       可能已在发送的UART_RTS_MARGIN字节）时暂停对方发送，下次更新前不会溢出
+ */
+RAMFUNC static void uart_rx_rts_update(uart_rx_t *rx)
+{
+    if (rx->rts_port == NULL) {
+        return;
+    }
+    
+    // RTS低电平有效，高电平暂停对方发送
+    if (rx->head - rx->tail > rx->size / 2U - UART_RTS_MARGIN) {
+        rx->rts_port->BSRR = rx->rts_pin;
+    } else {
+        rx->rts_port->BRR = rx->rts_pin;
+    }
+}
+
+/**
+ * @brief 启动DMA循环接收和空闲线路中断
+ * @note USART1_RX/USART2_RX/USART3_RX分别固定在DMA1通道5/6/3
+ */
+static void uart_rx_start(uint8_t uart_num, USART_TypeDef *usart)
+{
+    static uint8_t * const buffers[3] = {
+        g_uart1_rx_buffer, g_uart2_rx_buffer, g_uart3_rx_buffer
+    };
+    static const uint16_t sizes[3] = {
+        UART1_RX_BUFFER_SIZE, UART2_RX_BUFFER_SIZE, UART3_RX_BUFFER_SIZE
+    };
+    static const uint8_t channels[3] = { 5, 6, 3 };
+    static const IRQn_Type usart_irqs[3] = { USART1_IRQn, USART2_IRQn, USART3_IRQn };
+    static const IRQn_Type dma_irqs[3] = {
+        DMA1_Channel5_IRQn, DMA1_Channel6_IRQn, DMA1_Channel3_IRQn
+    };
+    DMA_Channel_TypeDef * const dma_channels[3] = {
+        DMA1_Channel5, DMA1_Channel6, DMA1_Channel3
+    };
+    
+    uint8_t idx = uart_num - 1;
+    uart_rx_t *rx = &g_uart_rx[idx];
+    
+    NVIC_DisableIRQ(usart_irqs[idx]);
+    NVIC_DisableIRQ(dma_irqs[idx]);
+    
+    // 重新初始化（如切换波特率）时丢弃未读数据，统计保留
+    rx->buffer = buffers[idx];
+    rx->size = sizes[idx];
+    rx->dma_pos = 0;
+    rx->head = 0;
+    rx->tail = 0;
+    rx->usart = usart;
+    rx->dma = dma_channels[idx];
+    rx->dma_channel = channels[idx];
+    
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    
+    rx->dma->CCR &= ~DMA_CCR1_EN;
+    DMA1->IFCR = 0xFUL << ((rx->dma_channel - 1) * 4);
+    rx->dma->CPAR = (uint32_t)&usart->DR;
+    rx->dma->CMAR = (uint32_t)rx->buffer;
+    rx->dma->CNDTR = rx->size;
+    // 外设到内存、内存地址递增、循环模式、半满/全满中断
+    rx->dma->CCR = DMA_CCR1_MINC | DMA_CCR1_CIRC | DMA_CCR1_HTIE | DMA_CCR1_TCIE | DMA_CCR1_PL_1;
+    rx->dma->CCR |= DMA_CCR1_EN;
+    
+    usart->CR3 |= USART_CR3_DMAR;
+    usart->CR1 |= USART_CR1_IDLEIE;
+    uart_rx_rts_update(rx);
+    
+    NVIC_EnableIRQ(dma_irqs[idx]);
+    NVIC_EnableIRQ(usart_irqs[idx]);
+}
+
+/**
+ * @brief 获取UART发送缓冲区（未初始化返回NULL）
+ */
+RAMFUNC static uart_tx_t *uart_tx_get(uint8_t uart_num)
+{
+    if (uart_num < 1 || uart_num > 3 || g_uart_tx[uart_num - 1].buffer == NULL) {
+        return NULL;
+    }
+    return &g_uart_tx[uart_num - 1];
+}
+
+/**
+ * @brief 启动DMA发送通道
+ * @note USART1_TX/USART2_TX/USART3_TX分别固定在DMA1通道4/7/2
+ */
+static void uart_tx_start(uint8_t uart_num, USART_TypeDef *usart)
+{
+    static uint8_t * const buffers[3] = {
+        g_uart1_tx_buffer, g_uart2_tx_buffer, g_uart3_tx_buffer
+    };
+    static const uint16_t sizes[3] = {
+        UART1_TX_BUFFER_SIZE, UART2_TX_BUFFER_SIZE, UART3_TX_BUFFER_SIZE
+    };
+    static const uint8_t channels[3] = { 4, 7, 2 };
+    static const IRQn_Type dma_irqs[3] = {
+        DMA1_Channel4_IRQn, DMA1_Channel7_IRQn, DMA1_Channel2_IRQn
+    };
+    DMA_Channel_TypeDef * const dma_channels[3] = {
+        DMA1_Channel4, DMA1_Channel7, DMA1_Channel2
+    };
+    
+    uint8_t idx = uart_num - 1;
+    uart_tx_t *tx = &g_uart_tx[idx];
+    
+    NVIC_DisableIRQ(dma_irqs[idx]);
+    
+    // 回调设置保留
+    tx->buffer = buffers[idx];
+    tx->size = sizes[idx];
+    tx->dma_len = 0;
+    tx->head = 0;
+    tx->tail = 0;
+    tx->usart = usart;
+    tx->dma = dma_channels[idx];
+    tx->dma_channel = channels[idx];
+    
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    
+    tx->dma->CCR &= ~DMA_CCR1_EN;
+    DMA1->IFCR = 0xFUL << ((tx->dma_channel - 1) * 4);
+    tx->dma->CPAR = (uint32_t)&usart->DR;
+    // 内存到外设、内存地址递增、传输完成中断
+    tx->dma->CCR = DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_TCIE;
+    
+    usart->CR3 |= USART_CR3_DMAT;
+    
+    NVIC_EnableIRQ(dma_irqs[idx]);
+}
+
+/**
+ * @brief DMA空闲时启动下一段发送（调用者需关中断或在中断中调用）
+ */
+RAMFUNC static void uart_tx_kick(uart_tx_t *tx)
+{
+    if (tx->dma_len != 0 || tx->head == tx->tail) {
+        return;
+    }
+    
+    // 一次只发送到缓冲区末尾，回绕部分在完成中断中继续
+    uint32_t offset = tx->tail % tx->size;
+    uint32_t len = tx->head - tx->tail;
+    if (len > tx->size - offset) {
+        len = tx->size - offset;
+    }
+    
+    tx->dma->CCR &= ~DMA_CCR1_EN;
+    tx->dma->CMAR = (uint32_t)(tx->buffer + offset);
+    tx->dma->CNDTR = len;
+    tx->dma_len = (uint16_t)len;
+    tx->dma->CCR |= DMA_CCR1_EN;
+}
+
+/**
+ * @brief 根据DMA剩余计数更新已接收字节数（调用者需关中断或在中断中调用）
+ */
+RAMFUNC static void uart_rx_update(uart_rx_t *rx)
+{
+    uint16_t pos = rx->size - (uint16_t)rx->dma->CNDTR;
+    if (pos >= rx->size) {
+        pos = 0;
+    }
+    
+    // 半满/全满中断保证两次更新之间DMA前进不超过半圈
+    uint16_t delta = (pos >= rx->dma_pos) ? (pos - rx->dma_pos) : (rx->size - rx->dma_pos + pos);
+    rx->dma_pos = pos;
+    rx->head += delta;
+    
+    // 缓冲区已满，最旧的数据被DMA覆盖
+    if (rx->head - rx->tail > rx->size) {
+        rx->rx_overruns += rx->head - rx->tail - rx->size;
+        rx->tail = rx->head - rx->size;
+    }
+    
+    uart_rx_rts_update(rx);
+}
+
 int uart_init(uint8_t uart_num, uint32_t baudrate)
 {
     if (uart_num < 1 || uart_num > 3) {
         return -1;
     }
     
+    // 重新初始化（如切换波特率）前先发送完已排队的数据
+    uart_flush(uart_num, 100);
+    
 #ifdef USE_HAL_DRIVER
     UART_HandleTypeDef *huart = NULL;
     
@@ -180,11 +422,13 @@ int uart_init(uint8_t uart_num, uint32_t baudrate)
     huart->Init.StopBits = UART_STOPBITS_1;
     huart->Init.Parity = UART_PARITY_NONE;
     huart->Init.Mode = UART_MODE_TX_RX;
-    huart->Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    huart->Init.HwFlowCtl = g_uart_rx[uart_num - 1].rts_port ? UART_HWCONTROL_CTS : UART_HWCONTROL_NONE;
     huart->Init.OverSampling = UART_OVERSAMPLING_16;
     
     if (HAL_UART_Init(huart) == HAL_OK) {
         g_uart_handles[uart_num - 1] = huart;
+        uart_rx_start(uart_num, huart->Instance);
+        uart_tx_start(uart_num, huart->Instance);
         return 0;
     }
     return -1;
@@ -199,95 +443,294 @@ int uart_init(uint8_t uart_num, uint32_t baudrate)
     USART_InitStruct.USART_StopBits = USART_StopBits_1;
     USART_InitStruct.USART_Parity = USART_Parity_No;
     USART_InitStruct.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
-    USART_InitStruct.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStruct.USART_HardwareFlowControl = g_uart_rx[uart_num - 1].rts_port ?
+                                                 USART_HardwareFlowControl_CTS :
+                                                 USART_HardwareFlowControl_None;
     
     USART_Init(usart, &USART_InitStruct);
     USART_Cmd(usart, ENABLE);
     
     g_uart_handles[uart_num - 1] = (void *)usart;
+    uart_rx_start(uart_num, usart);
+    uart_tx_start(uart_num, usart);
     return 0;
 #endif
 }
 
 int uart_send_byte(uint8_t uart_num, uint8_t byte)
 {
-    if (uart_num < 1 || uart_num > 3) {
+    return uart_write(uart_num, &byte, 1);
+}
+
+int uart_send_string(uint8_t uart_num, const char *str)
+{
+    if (str == NULL) {
         return -1;
     }
     
-#ifdef USE_HAL_DRIVER
-    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)g_uart_handles[uart_num - 1];
-    if (huart == NULL) {
+    uint32_t len = strlen(str);
+    if (uart_write(uart_num, (const uint8_t *)str, len) != 0) {
+        return 0;
+    }
+    return (int)len;
+}
+
+int uart_write_async(uint8_t uart_num, const uint8_t *data, uint32_t len)
+{
+    uart_tx_t *tx = uart_tx_get(uart_num);
+    if (tx == NULL || data == NULL) {
         return -1;
     }
     
-    if (HAL_UART_Transmit(huart, &byte, 1, 1000) == HAL_OK) {
-        return 0;
+    // 只有本函数推进head，只有中断推进tail，空闲空间只会变多
+    uint32_t space = tx->size - (tx->head - tx->tail);
+    if (len > space) {
+        len = space;
     }
-    return -1;
-#else
-    // 标准外设库方式
-    USART_TypeDef *usart = (USART_TypeDef *)g_uart_handles[uart_num - 1];
-    if (usart == NULL) {
-        return -1;
+    
+    uint32_t offset = tx->head % tx->size;
+    uint32_t first = tx->size - offset;
+    if (first > len) {
+        first = len;
     }
+    memcpy(tx->buffer + offset, data, first);
+    memcpy(tx->buffer, data + first, len - first);
     
-    // 等待发送缓冲区空
-    while (!(usart->SR & USART_SR_TXE));
-    usart->DR = byte;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    tx->head += len;
+    uart_tx_kick(tx);
+    __set_PRIMASK(primask);
     
+    return (int)len;
+}
+
+int uart_write(uint8_t uart_num, const uint8_t *data, uint32_t len)
+{
+    while (len > 0) {
+        int n = uart_write_async(uart_num, data, len);
+        if (n < 0) {
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
     return 0;
-#endif
 }
 
-int uart_send_string(uint8_t uart_num, const char *str)
+int uart_set_tx_callback(uint8_t uart_num, uart_tx_complete_cb callback, void *ctx)
 {
-    if (str == NULL) {
+    if (uart_num < 1 || uart_num > 3) {
         return -1;
     }
     
-    int len = 0;
-    while (*str) {
-        if (uart_send_byte(uart_num, *str) != 0) {
-            break;
+    uart_tx_t *tx = &g_uart_tx[uart_num - 1];
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    tx->callback = callback;
+    tx->callback_ctx = ctx;
+    __set_PRIMASK(primask);
+    
+    return 0;
+}
+
+int uart_flush(uint8_t uart_num, uint32_t timeout_ms)
+{
+    uart_tx_t *tx = uart_tx_get(uart_num);
+    if (tx == NULL) {
+        return 0;
+    }
+    
+    uint32_t start_time = get_system_tick();
+    
+    // 等待DMA发送完排队数据，再等待最后一个字节移出移位寄存器
+    while (tx->head != tx->tail || !(tx->usart->SR & USART_SR_TC)) {
+        if ((get_system_tick() - start_time) >= timeout_ms) {
+            return -1;
         }
-        str++;
-        len++;
     }
-    return len;
+    
+    return 0;
 }
 
-int uart_receive_byte(uint8_t uart_num, uint8_t *byte)
+RAMFUNC void uart_tx_irq_handler(uint8_t uart_num)
 {
-    if (byte == NULL || uart_num < 1 || uart_num > 3) {
-        return -1;
+    uart_tx_t *tx = uart_tx_get(uart_num);
+    if (tx == NULL) {
+        return;
     }
     
-#ifdef USE_HAL_DRIVER
-    UART_HandleTypeDef *huart = (UART_HandleTypeDef *)g_uart_handles[uart_num - 1];
-    if (huart == NULL) {
-        return -1;
+    DMA1->IFCR = 0xFUL << ((tx->dma_channel - 1) * 4);
+    
+    tx->tail += tx->dma_len;
+    tx->dma_len = 0;
+    uart_tx_kick(tx);
+    
+    if (tx->head == tx->tail && tx->callback) {
+        tx->callback(uart_num, tx->callback_ctx);
+    }
+}
+
+uint32_t uart_read(uint8_t uart_num, uint8_t *buffer, uint32_t size)
+{
+    uart_rx_t *rx = uart_rx_get(uart_num);
+    if (rx == NULL || buffer == NULL) {
+        return 0;
+    }
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uart_rx_update(rx);
+    uint32_t tail = rx->tail;
+    uint32_t available = rx->head - tail;
+    __set_PRIMASK(primask);
+    
+    if (size > available) {
+        size = available;
+    }
+    
+    // 环形缓冲区可能回绕，分两段复制
+    uint32_t offset = tail % rx->size;
+    uint32_t first = rx->size - offset;
+    if (first > size) {
+        first = size;
     }
+    memcpy(buffer, rx->buffer + offset, first);
+    memcpy(buffer + first, rx->buffer, size - first);
+    
+    // 复制期间中断可能因溢出推进了tail，不能回退
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if ((int32_t)(rx->tail - (tail + size)) < 0) {
+        rx->tail = tail + size;
+    }
+    uart_rx_rts_update(rx);
+    __set_PRIMASK(primask);
     
-    // 非阻塞接收
-    if (HAL_UART_Receive(huart, byte, 1, 0) == HAL_OK) {
+    return size;
+}
+
+uint32_t uart_rx_available(uint8_t uart_num)
+{
+    uart_rx_t *rx = uart_rx_get(uart_num);
+    if (rx == NULL) {
         return 0;
     }
-    return -1;
-#else
-    // 标准外设库方式
-    USART_TypeDef *usart = (USART_TypeDef *)g_uart_handles[uart_num - 1];
-    if (usart == NULL) {
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uart_rx_update(rx);
+    uint32_t available = rx->head - rx->tail;
+    __set_PRIMASK(primask);
+    
+    return available;
+}
+
+uint32_t uart_rx_capacity(uint8_t uart_num)
+{
+    static const uint16_t sizes[3] = {
+        UART1_RX_BUFFER_SIZE, UART2_RX_BUFFER_SIZE, UART3_RX_BUFFER_SIZE
+    };
+    
+    if (uart_num < 1 || uart_num > 3) {
+        return 0;
+    }
+    return sizes[uart_num - 1];
+}
+
+int uart_get_stats(uint8_t uart_num, uart_stats_t *stats)
+{
+    uart_rx_t *rx = uart_rx_get(uart_num);
+    if (rx == NULL || stats == NULL) {
         return -1;
     }
     
-    // 检查接收标志
-    if (usart->SR & USART_SR_RXNE) {
-        *byte = (uint8_t)(usart->DR & 0xFF);
-        return 0;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uart_rx_update(rx);
+    stats->rx_bytes = rx->head;
+    stats->rx_overruns = rx->rx_overruns;
+    stats->hw_overruns = rx->hw_overruns;
+    __set_PRIMASK(primask);
+    
+    return 0;
+}
+
+int uart_set_flow_control(uint8_t uart_num, bool enable)
+{
+    // RTS引脚：USART1/2/3分别为PA12/PA1/PB14（作为普通推挽输出，见system_init.c）
+    GPIO_TypeDef * const rts_ports[3] = { GPIOA, GPIOA, GPIOB };
+    static const uint16_t rts_pins[3] = { 1U << 12, 1U << 1, 1U << 14 };
+    USART_TypeDef * const usarts[3] = { USART1, USART2, USART3 };
+    
+    if (uart_num < 1 || uart_num > 3) {
+        return -1;
     }
-    return -1;
-#endif
+    
+    uint8_t idx = uart_num - 1;
+    uart_rx_t *rx = &g_uart_rx[idx];
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (enable) {
+        rx->rts_port = rts_ports[idx];
+        rx->rts_pin = rts_pins[idx];
+        usarts[idx]->CR3 |= USART_CR3_CTSE;
+        if (rx->buffer != NULL) {
+            uart_rx_update(rx);
+        } else {
+            rx->rts_port->BRR = rx->rts_pin;
+        }
+    } else {
+        // 停止控制前使RTS有效，对方不会一直暂停
+        if (rx->rts_port != NULL) {
+            rx->rts_port->BRR = rx->rts_pin;
+        }
+        rx->rts_port = NULL;
+        usarts[idx]->CR3 &= ~USART_CR3_CTSE;
+    }
+    __set_PRIMASK(primask);
+    
+    return 0;
+}
+
+bool uart_get_flow_control(uint8_t uart_num)
+{
+    if (uart_num < 1 || uart_num > 3) {
+        return false;
+    }
+    return g_uart_rx[uart_num - 1].rts_port != NULL;
+}
+
+RAMFUNC void uart_rx_irq_handler(uint8_t uart_num)
+{
+    uart_rx_t *rx = uart_rx_get(uart_num);
+    if (rx == NULL) {
+        return;
+    }
+    
+    // 先读SR再读DR清除IDLE/ORE标志
+    uint16_t sr = rx->usart->SR;
+    if (sr & (USART_SR_IDLE | USART_SR_ORE)) {
+        (void)rx->usart->DR;
+        if (sr & USART_SR_ORE) {
+            rx->hw_overruns++;
+        }
+    }
+    
+    // 清除DMA半满/全满标志
+    DMA1->IFCR = 0xFUL << ((rx->dma_channel - 1) * 4);
+    
+    uart_rx_update(rx);
+}
+
+int uart_receive_byte(uint8_t uart_num, uint8_t *byte)
+{
+    if (byte == NULL) {
+        return -1;
+    }
+    
+    return (uart_read(uart_num, byte, 1) == 1) ? 0 : -1;
 }
 
 int uart_receive(uint8_t uart_num, uint8_t *buffer, uint32_t size, uint32_t timeout_ms)
@@ -300,9 +743,9 @@ int uart_receive(uint8_t uart_num, uint8_t *buffer, uint32_t size, uint32_t time
     uint32_t received = 0;
     
     while (received < size) {
-        uint8_t byte;
-        if (uart_receive_byte(uart_num, &byte) == 0) {
-            buffer[received++] = byte;
+        uint32_t n = uart_read(uart_num, buffer + received, size - received);
+        if (n > 0) {
+            received += n;
         } else {
             if ((get_system_tick() - start_time) >= timeout_ms) {
                 break;  // 超时
@@ -314,6 +757,72 @@ int uart_receive(uint8_t uart_num, uint8_t *buffer, uint32_t size, uint32_t time
     return received;
 }
 
+// Bootloader不使用串口：启动文件的向量表引用这些函数，定义了就无法被--gc-sections去除
+#ifndef BOOTLOADER_BUILD
+// UART接收中断处理函数（需要在中断向量表中注册）
+RAMFUNC void USART1_IRQHandler(void)
+{
+    uart_rx_irq_handler(1);
+}
+
+RAMFUNC void USART2_IRQHandler(void)
+{
+    uart_rx_irq_handler(2);
+}
+
+RAMFUNC void USART3_IRQHandler(void)
+{
+    uart_rx_irq_handler(3);
+}
+
+RAMFUNC void DMA1_Channel5_IRQHandler(void)
+{
+    uart_rx_irq_handler(1);
+}
+
+RAMFUNC void DMA1_Channel6_IRQHandler(void)
+{
+    uart_rx_irq_handler(2);
+}
+
+RAMFUNC void DMA1_Channel3_IRQHandler(void)
+{
+    uart_rx_irq_handler(3);
+}
+
+// UART发送DMA中断处理函数（需要在中断向量表中注册）
+RAMFUNC void DMA1_Channel4_IRQHandler(void)
+{
+    uart_tx_irq_handler(1);
+}
+
+RAMFUNC void DMA1_Channel7_IRQHandler(void)
+{
+    uart_tx_irq_handler(2);
+}
+
+RAMFUNC void DMA1_Channel2_IRQHandler(void)
+{
+    uart_tx_irq_handler(3);
+}
+#endif
+
+// ==================== CRC单元实现 ====================
+
+RAMFUNC uint32_t crc_unit_calc(uint32_t seed, const uint32_t *data, uint32_t words)
+{
+    RCC->AHBENR |= RCC_AHBENR_CRCEN;
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = seed;
+    
+    // 每写一个字CRC单元用1个AHB周期，读DR时自动等待
+    for (uint32_t i = 0; i < words; i++) {
+        CRC->DR = __RBIT(data[i]);
+    }
+    
+    return CRC->DR;
+}
+
 // ==================== 系统时钟实现 ====================
 
 uint32_t get_system_tick(void)
@@ -341,10 +850,11 @@ void delay_ms(uint32_t ms)
 }
 
 // SysTick中断处理函数（需要在中断向量表中注册）
-void SysTick_Handler(void)
+RAMFUNC void SysTick_Handler(void)
 {
 #ifdef USE_HAL_DRIVER
-    HAL_IncTick();
+    // 与HAL_IncTick()相同（HAL_IncTick在Flash中）
+    uwTick += uwTickFreq;
 #else
     // 标准外设库方式
     extern volatile uint32_t uwTick;
@@ -352,6 +862,30 @@ void SysTick_Handler(void)
 #endif
 }
 
+// ==================== 中断向量表 ====================
+
+// RAM中的向量表：F103中密度为16个系统异常 + 43个外设中断，
+// VTOR要求按表大小向上取2的幂对齐（64项 × 4字节 = 256字节）
+#define VECTOR_TABLE_ENTRIES   64
+static uint32_t g_ram_vector_table[VECTOR_TABLE_ENTRIES] __attribute__((aligned(256)));
+
+void system_relocate_vector_table(void)
+{
+    // 本程序的向量表（链接脚本中.isr_vector段起始，Bootloader跳转后VTOR可能仍指向Bootloader）
+    extern const uint32_t _sisr_vector[];
+    
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    
+    for (uint32_t i = 0; i < VECTOR_TABLE_ENTRIES; i++) {
+        g_ram_vector_table[i] = _sisr_vector[i];
+    }
+    SCB->VTOR = (uint32_t)g_ram_vector_table;
+    __DSB();
+    
+    __set_PRIMASK(primask);
+}
+
 // ==================== GPIO操作实现 ====================
 
 bool gpio_read_pin(void *port, uint16_t pin)
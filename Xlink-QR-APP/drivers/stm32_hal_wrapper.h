@@ -14,24 +14,36 @@
 extern "C" {
 #endif
 
+// 放在RAM中执行的函数（链接脚本中.ramfunc段随.data在启动时复制到RAM）
+// Flash擦除或编程期间从Flash取指会使CPU暂停，Flash操作函数、中断处理函数
+// 放在RAM中，配合RAM中的向量表，擦除期间串口接收和系统时钟照常运行。
+// RAM与Flash相距超过BL指令范围，需要long_call。
+// Bootloader（BOOTLOADER_BUILD）不开中断，Flash操作期间CPU暂停即可，这些函数留在Flash中：
+// .ramfunc是一个整段，不能按函数去除未使用的部分，还要同时占用Flash和RAM
+#if defined(__arm__) && !defined(FLASH_SIM) && !defined(BOOTLOADER_BUILD)
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline, long_call))
+#else
+#define RAMFUNC
+#endif
+
 // ==================== Flash操作 ====================
 
 /**
  * @brief 解锁Flash
  */
-void flash_unlock(void);
+RAMFUNC void flash_unlock(void);
 
 /**
  * @brief 锁定Flash
  */
-void flash_lock(void);
+RAMFUNC void flash_lock(void);
 
 /**
  * @brief 擦除Flash页
  * @param page_addr 页地址
  * @return 0成功，-1失败
  */
-int flash_erase_page(uint32_t page_addr);
+RAMFUNC int flash_erase_page(uint32_t page_addr);
 
 /**
  * @brief 编程Flash字（32位）
@@ -39,10 +51,82 @@ int flash_erase_page(uint32_t page_addr);
  * @param data 数据
  * @return 0成功，-1失败
  */
-int flash_program_word(uint32_t addr, uint32_t data);
+RAMFUNC int flash_program_word(uint32_t addr, uint32_t data);
+
+/**
+ * @brief 连续编程一段Flash（按16位半字）
+ * @param addr 起始地址（必须2字节对齐）
+ * @param data 数据（无对齐要求）
+ * @param len 数据长度（奇数长度时最后一个字节补0xFF）
+ * @param fail_addr 第一个编程失败的地址（输出，可选）
+ * @return 0成功，-1失败
+ * @note 整段编程期间PG位保持置位，只在开始时等待空闲、检查解锁一次；
+ *       与Flash现有内容相同的半字直接跳过（目标区域只需在需要编程的半字处
+ *       为空白）。每个半字编程后检查错误标志并回读比较，值为0xFFFF的半字
+ *       也要求Flash为空白，返回0时整段内容与数据完全一致。
+ */
+RAMFUNC int flash_program_buffer(uint32_t addr, const uint8_t *data, uint32_t len, uint32_t *fail_addr);
+
+// ==================== CRC单元 ====================
+
+/**
+ * @brief 用CRC单元计算一段数据
+ * @param seed 复位后首先写入的字（用于设置起始值，见crc32.c）
+ * @param data 数据（4字节对齐），每个字按位反转后写入
+ * @param words 字数
+ * @return 最后的CRC_DR
+ * @note CRC单元固定为CRC-32/MPEG-2：多项式0x04C11DB7、复位值0xFFFFFFFF、
+ *       高位在前、每次一个字，没有输入输出反射和结果异或
+ */
+RAMFUNC uint32_t crc_unit_calc(uint32_t seed, const uint32_t *data, uint32_t words);
 
 // ==================== UART操作 ====================
 
+// UART接收环形缓冲区大小（DMA循环接收，字节）
+// 缓冲区要能容纳CPU最长不读取期间（如Flash擦除、编程）到达的数据，
+// 容纳不下时启用流控（uart_set_flow_control）或降低波特率
+#ifndef UART1_RX_BUFFER_SIZE
+#define UART1_RX_BUFFER_SIZE     128     // UART1 - 二维码扫描
+#endif
+#ifndef UART2_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE     64      // UART2 - 调试输出
+#endif
+#ifndef UART3_RX_BUFFER_SIZE
+#define UART3_RX_BUFFER_SIZE     2048    // UART3 - WiFi模块（921600波特率下约22ms）
+#endif
+
+// 软件RTS余量（字节）：对方看到RTS暂停前可能已开始发送的字节数
+#ifndef UART_RTS_MARGIN
+#define UART_RTS_MARGIN          16
+#endif
+
+// UART发送环形缓冲区大小（DMA发送，字节）
+#ifndef UART1_TX_BUFFER_SIZE
+#define UART1_TX_BUFFER_SIZE     64      // UART1 - 二维码扫描
+#endif
+#ifndef UART2_TX_BUFFER_SIZE
+#define UART2_TX_BUFFER_SIZE     512     // UART2 - 调试输出
+#endif
+#ifndef UART3_TX_BUFFER_SIZE
+#define UART3_TX_BUFFER_SIZE     512     // UART3 - WiFi模块（可容纳一个完整的HTTP请求）
+#endif
+
+/**
+ * @brief UART发送完成回调（发送缓冲区中的数据全部交给USART后在中断中调用）
+ * @param uart_num UART编号
+ * @param ctx 用户上下文
+ * @note 中断处理在RAM中执行，回调在Flash中时Flash操作期间调用会暂停到
+ *       操作结束；需要在Flash操作期间执行的回调用RAMFUNC修饰
+ */
+typedef void (*uart_tx_complete_cb)(uint8_t uart_num, void *ctx);
+
+// UART统计信息
+typedef struct {
+    uint32_t rx_bytes;           // 接收字节总数
+    uint32_t rx_overruns;        // 环形缓冲区满被覆盖丢弃的字节数
+    uint32_t hw_overruns;        // USART硬件溢出（ORE）次数
+} uart_stats_t;
+
 /**
  * @brief 初始化UART
  * @param uart_num UART编号（1-3）
@@ -64,9 +148,46 @@ int uart_send_byte(uint8_t uart_num, uint8_t byte);
  * @param uart_num UART编号
  * @param str 字符串
  * @return 发送的字节数
+ * @note 数据复制到发送缓冲区后立即返回，由DMA在后台发送；
+ *       只有发送缓冲区已满时才等待
  */
 int uart_send_string(uint8_t uart_num, const char *str);
 
+/**
+ * @brief 异步发送数据（非阻塞）
+ * @param uart_num UART编号
+ * @param data 数据
+ * @param len 数据长度
+ * @return 放入发送缓冲区的字节数（缓冲区空间不足时小于len），-1失败
+ */
+int uart_write_async(uint8_t uart_num, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 发送数据（发送缓冲区满时等待空间）
+ * @param uart_num UART编号
+ * @param data 数据
+ * @param len 数据长度
+ * @return 0成功，-1失败
+ */
+int uart_write(uint8_t uart_num, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief 设置发送完成回调
+ * @param uart_num UART编号
+ * @param callback 回调函数（NULL取消）
+ * @param ctx 用户上下文
+ * @return 0成功，-1失败
+ */
+int uart_set_tx_callback(uint8_t uart_num, uart_tx_complete_cb callback, void *ctx);
+
+/**
+ * @brief 等待已排队的数据全部发送到线路上
+ * @param uart_num UART编号
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 0成功，-1超时
+ */
+int uart_flush(uint8_t uart_num, uint32_t timeout_ms);
+
 /**
  * @brief 接收一个字节（非阻塞）
  * @param uart_num UART编号
@@ -75,6 +196,71 @@ int uart_send_string(uint8_t uart_num, const char *str);
  */
 int uart_receive_byte(uint8_t uart_num, uint8_t *byte);
 
+/**
+ * @brief 从接收环形缓冲区读取数据（非阻塞）
+ * @param uart_num UART编号
+ * @param buffer 缓冲区
+ * @param size 最多读取的字节数
+ * @return 实际读取的字节数（0表示无数据）
+ * @note 数据由DMA在后台循环接收，两次读取之间CPU可以任意延时或编程Flash，
+ *       只要期间到达的数据不超过缓冲区大小就不会丢失
+ */
+uint32_t uart_read(uint8_t uart_num, uint8_t *buffer, uint32_t size);
+
+/**
+ * @brief 获取接收环形缓冲区中可读的字节数
+ * @param uart_num UART编号
+ * @return 可读字节数
+ */
+uint32_t uart_rx_available(uint8_t uart_num);
+
+/**
+ * @brief 获取接收环形缓冲区大小
+ * @param uart_num UART编号
+ * @return 缓冲区大小（字节），0表示UART编号无效
+ */
+uint32_t uart_rx_capacity(uint8_t uart_num);
+
+/**
+ * @brief 获取UART统计信息
+ * @param uart_num UART编号
+ * @param stats 统计信息（输出）
+ * @return 0成功，-1失败
+ */
+int uart_get_stats(uint8_t uart_num, uart_stats_t *stats);
+
+/**
+ * @brief 启用或关闭RTS/CTS流控
+ * @param uart_num UART编号
+ * @param enable true启用
+ * @return 0成功，-1失败
+ * @note CTS由USART处理（对方拉高CTS时暂停发送）。DMA循环接收时USART的硬件RTS
+ *       只反映数据寄存器是否已读出，不能防止环形缓冲区被覆盖，因此RTS引脚作为
+ *       普通输出由驱动按缓冲区使用量控制：超过半个缓冲区时暂停对方发送，读取后恢复。
+ *       引脚由system_init.c配置；设置在之后的uart_init中保持有效；
+ *       对方也要启用流控（ESP8266：AT+UART_CUR的流控参数为3）
+ */
+int uart_set_flow_control(uint8_t uart_num, bool enable);
+
+/**
+ * @brief 查询是否已启用RTS/CTS流控
+ * @param uart_num UART编号
+ * @return true已启用
+ */
+bool uart_get_flow_control(uint8_t uart_num);
+
+/**
+ * @brief UART接收中断处理（空闲线路中断、DMA半满/全满中断共用）
+ * @param uart_num UART编号
+ */
+RAMFUNC void uart_rx_irq_handler(uint8_t uart_num);
+
+/**
+ * @brief UART发送DMA完成中断处理
+ * @param uart_num UART编号
+ */
+RAMFUNC void uart_tx_irq_handler(uint8_t uart_num);
+
 /**
  * @brief 接收数据（阻塞，带超时）
  * @param uart_num UART编号
@@ -99,6 +285,13 @@ uint32_t get_system_tick(void);
  */
 void delay_ms(uint32_t ms);
 
+/**
+ * @brief 把中断向量表复制到RAM并切换VTOR
+ * @note 异常进入时从向量表读取处理函数地址，向量表在Flash中时擦除期间
+ *       无法响应中断；系统初始化时、使能中断前调用
+ */
+void system_relocate_vector_table(void);
+
 // ==================== GPIO操作 ====================
 
 /**
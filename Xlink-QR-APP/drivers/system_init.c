@@ -199,6 +199,21 @@ void UART_GPIO_Init(uint8_t uart_num)
         GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
         GPIO_InitStruct.Pull = GPIO_NOPULL;
         HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+        
+#if WIFI_UART_FLOW_CONTROL
+        // 流控：PB13(CTS)输入，PB14(RTS)普通推挽输出（由驱动按接收缓冲区控制），初始有效
+        GPIO_InitStruct.Pin = GPIO_PIN_13;
+        GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+        GPIO_InitStruct.Pull = GPIO_PULLUP;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+        
+        HAL_GPIO_WritePin(GPIOB, GPIO_PIN_14, GPIO_PIN_RESET);
+        GPIO_InitStruct.Pin = GPIO_PIN_14;
+        GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+        GPIO_InitStruct.Pull = GPIO_NOPULL;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+#endif
     }
 #else
     // 标准外设库方式
@@ -242,6 +257,19 @@ void UART_GPIO_Init(uint8_t uart_num)
         GPIO_InitStructure.GPIO_Pin = GPIO_Pin_11;
         GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
         GPIO_Init(GPIOB, &GPIO_InitStructure);
+        
+#if WIFI_UART_FLOW_CONTROL
+        // 流控：PB13(CTS)输入，PB14(RTS)普通推挽输出（由驱动按接收缓冲区控制），初始有效
+        GPIO_InitStructure.GPIO_Pin = GPIO_Pin_13;
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+        GPIO_Init(GPIOB, &GPIO_InitStructure);
+        
+        GPIO_ResetBits(GPIOB, GPIO_Pin_14);
+        GPIO_InitStructure.GPIO_Pin = GPIO_Pin_14;
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+        GPIO_Init(GPIOB, &GPIO_InitStructure);
+#endif
     }
 #endif
 }
@@ -251,6 +279,9 @@ void UART_GPIO_Init(uint8_t uart_num)
  */
 void System_Init(void)
 {
+    // 向量表和中断处理函数都在RAM中，Flash擦除期间仍能响应中断
+    system_relocate_vector_table();
+    
     // 系统时钟配置
     SystemClock_Config();
     
@@ -266,5 +297,8 @@ void System_Init(void)
     uart_init(1, QR_UART_BAUDRATE);
     uart_init(2, DEBUG_UART_BAUDRATE);
     uart_init(3, WIFI_UART_BAUDRATE);
+#if WIFI_UART_FLOW_CONTROL
+    uart_set_flow_control(3, true);
+#endif
 }
 
@@ -0,0 +1,87 @@
+/**
+ * @file gen_crc32_table.c
+ * @brief 生成CRC32查找表头文件（构建时在主机上运行，见Makefile）
+ * @note 用法：gen_crc32_table > build/gen/crc32_table.h
+ *       输出所有表格方案，由common/crc32.c按CRC32_TABLE选择其中一种编译。
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+// IEEE 802.3多项式（反射）
+#define CRC32_POLY  0xEDB88320u
+
+/**
+ * @brief 逐位计算bits位
+ */
+static uint32_t crc_bits(uint32_t crc, int bits)
+{
+    for (int i = 0; i < bits; i++) {
+        crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLY : crc >> 1;
+    }
+    return crc;
+}
+
+/**
+ * @brief 输出一个表（每行8项）
+ */
+static void print_table(const uint32_t *table, int count, const char *indent)
+{
+    for (int i = 0; i < count; i++) {
+        printf("%s0x%08X%s", (i % 8 == 0) ? indent : " ",
+               (unsigned)table[i], (i + 1 < count) ? "," : "");
+        if (i % 8 == 7 || i + 1 == count) {
+            printf("\n");
+        }
+    }
+}
+
+int main(void)
+{
+    uint32_t nibble[16];
+    uint32_t table[8][256];
+    
+    for (int n = 0; n < 16; n++) {
+        nibble[n] = crc_bits((uint32_t)n, 4);
+    }
+    for (int n = 0; n < 256; n++) {
+        table[0][n] = crc_bits((uint32_t)n, 8);
+    }
+    // 第k个表：字节n后面再跟k个0字节
+    for (int k = 1; k < 8; k++) {
+        for (int n = 0; n < 256; n++) {
+            uint32_t c = table[k - 1][n];
+            table[k][n] = (c >> 8) ^ table[0][c & 0xFF];
+        }
+    }
+    
+    printf("/**\n");
+    printf(" * @file crc32_table.h\n");
+    printf(" * @brief CRC32查找表（由scripts/gen_crc32_table.c生成，不要手工修改）\n");
+    printf(" * @note 多项式0x%08X，只能由crc32.c包含\n", (unsigned)CRC32_POLY);
+    printf(" */\n\n");
+    
+    printf("#if CRC32_TABLE == CRC32_TABLE_NIBBLE\n\n");
+    printf("static const uint32_t crc32_table_nibble[16] = {\n");
+    print_table(nibble, 16, "    ");
+    printf("};\n\n");
+    
+    printf("#else\n\n");
+    printf("// crc32_table[k][n]：字节n后面再跟k个0字节的CRC\n");
+    printf("static const uint32_t crc32_table[CRC32_TABLE][256] = {\n");
+    for (int k = 0; k < 8; k++) {
+        if (k == 1) {
+            printf("#if CRC32_TABLE >= CRC32_TABLE_SLICE4\n");
+        } else if (k == 4) {
+            printf("#endif\n#if CRC32_TABLE >= CRC32_TABLE_SLICE8\n");
+        }
+        printf("    {\n");
+        print_table(table[k], 256, "        ");
+        printf("    },\n");
+    }
+    printf("#endif\n");
+    printf("};\n\n");
+    
+    printf("#endif\n");
+    return 0;
+}
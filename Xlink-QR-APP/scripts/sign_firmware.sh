@@ -0,0 +1,68 @@
+#!/bin/bash
+# 固件签名脚本（Ed25519，需要OpenSSL 1.1.1以上）
+#
+# 生成密钥（私钥妥善保管，公钥写入common/signing_key.h）：
+#   scripts/sign_firmware.sh keygen <私钥.pem>
+# 签名（在固件末尾附加72字节签名块，见common/firmware_sign.h）：
+#   scripts/sign_firmware.sh sign <私钥.pem> <固件.bin> <输出.bin>
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+KEY_HEADER="$(dirname "$SCRIPT_DIR")/common/signing_key.h"
+
+# 输出小端32位整数
+le32() {
+    local v=$1
+    printf "$(printf '\\x%02x\\x%02x\\x%02x\\x%02x' \
+        $((v & 255)) $(((v >> 8) & 255)) $(((v >> 16) & 255)) $(((v >> 24) & 255)))"
+}
+
+case "$1" in
+    keygen)
+        [ $# -eq 2 ] || { echo "用法: $0 keygen <私钥.pem>"; exit 1; }
+        if [ -e "$2" ]; then
+            echo "✗ $2 已存在"
+            exit 1
+        fi
+        openssl genpkey -algorithm ed25519 -out "$2"
+        chmod 600 "$2"
+        
+        # 公钥为DER编码的最后32字节
+        KEY_BYTES=$(openssl pkey -in "$2" -pubout -outform DER | tail -c 32 | \
+                    od -An -v -tx1 | tr -s ' \n' ' ' | sed 's/^ //; s/ $//; s/\([0-9a-f][0-9a-f]\)/0x\1,/g; s/,$//')
+        {
+            echo "/**"
+            echo " * @file signing_key.h"
+            echo " * @brief 固件签名公钥（由scripts/sign_firmware.sh keygen生成）"
+            echo " */"
+            echo ""
+            echo "#ifndef SIGNING_KEY_H"
+            echo "#define SIGNING_KEY_H"
+            echo ""
+            echo "#define FIRMWARE_SIGNING_KEY { $KEY_BYTES }"
+            echo ""
+            echo "#endif // SIGNING_KEY_H"
+        } > "$KEY_HEADER"
+        echo "✓ 私钥: $2"
+        echo "✓ 公钥: $KEY_HEADER"
+        ;;
+    sign)
+        [ $# -eq 4 ] || { echo "用法: $0 sign <私钥.pem> <固件.bin> <输出.bin>"; exit 1; }
+        SIZE=$(($(wc -c < "$3")))
+        SIG=$(mktemp)
+        trap 'rm -f "$SIG"' EXIT
+        openssl pkeyutl -sign -inkey "$2" -rawin -in "$3" -out "$SIG"
+        {
+            cat "$3" "$SIG"
+            le32 0x4E474953     # FIRMWARE_SIGNATURE_MAGIC
+            le32 "$SIZE"
+        } > "$4"
+        echo "✓ $4（固件${SIZE}字节 + 签名块72字节）"
+        ;;
+    *)
+        echo "用法: $0 keygen <私钥.pem>"
+        echo "      $0 sign <私钥.pem> <固件.bin> <输出.bin>"
+        exit 1
+        ;;
+esac
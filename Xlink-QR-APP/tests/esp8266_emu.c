@@ -0,0 +1,663 @@
+/**
+ * @file esp8266_emu.c
+ * @brief 主机测试用的ESP8266模块和HTTP服务器模拟器实现
+ */
+
+#include "esp8266_emu.h"
+#include "flash_sim.h"
+#include "stm32_hal_wrapper.h"
+#include "../config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EMU_DEFAULT_BAUDRATE   115200
+#define EMU_RX_RING_SIZE       UART3_RX_BUFFER_SIZE
+
+// 模块的输入状态
+typedef enum {
+    EMU_INPUT_COMMAND = 0,       // AT命令行
+    EMU_INPUT_SEND,              // AT+CIPSEND=<n>之后的n字节数据
+    EMU_INPUT_PASSTHROUGH        // 透传
+} emu_input_t;
+
+// 模块发出的字节从mark起不早于ready_ns上线
+typedef struct {
+    uint32_t index;
+    uint64_t ready_ns;
+} emu_mark_t;
+
+#define EMU_MAX_MARKS          64
+
+static esp8266_emu_config_t g_config;
+static esp8266_emu_server_t g_server;
+static esp8266_emu_stats_t g_stats;
+static uint32_t g_drops_left;
+static bool g_redirected;
+
+// 模块状态
+static uint32_t g_module_baud;
+static uint32_t g_pending_baud;          // AT+UART_CUR：回复发送完后切换
+static uint32_t g_pending_baud_at;       // 切换时的输出位置
+static uint32_t g_pending_flow;
+static bool g_module_flow;               // 模块按CTS（MCU的RTS）暂停发送
+static bool g_echo;
+static bool g_cipmode;
+static bool g_connected;
+static emu_input_t g_input;
+static char g_line[600];
+static uint32_t g_line_len;
+static uint32_t g_send_remaining;
+static uint64_t g_last_input_ns;
+
+// 模块发往MCU的字节队列
+static uint8_t *g_out;
+static uint32_t g_out_len;
+static uint32_t g_out_cap;
+static uint32_t g_out_pos;               // 下一个上线的字节
+static emu_mark_t g_marks[EMU_MAX_MARKS];
+static uint32_t g_mark_count;
+static uint64_t g_wire_ns;               // 线路上一个字节发送完的时间
+static uint64_t g_tx_done_ns;            // MCU发送的数据全部到达模块的时间
+
+// MCU的接收环形缓冲区（与stm32_hal_wrapper.c相同的head/tail计数）
+static uint32_t g_host_baud;
+static uint8_t g_ring[EMU_RX_RING_SIZE];
+static uint32_t g_ring_head;
+static uint32_t g_ring_tail;
+static uart_stats_t g_uart_stats;
+static bool g_host_flow;                 // MCU按缓冲区使用量控制RTS（uart_set_flow_control）
+static bool g_rts_paused;                // RTS无效，模块暂停发送
+
+/**
+ * @brief 模拟时钟（纳秒）
+ */
+static uint64_t emu_now_ns(void)
+{
+    flash_sim_stats_t stats;
+    flash_sim_get_stats(&stats);
+    return stats.time_us * 1000;
+}
+
+/**
+ * @brief 一个字节（起始位+8数据位+停止位）的传输时间
+ */
+static uint64_t emu_byte_ns(uint32_t baudrate)
+{
+    return 10000000000ULL / baudrate;
+}
+
+/**
+ * @brief 模块发出数据（不早于ready_ns上线）
+ */
+static void emu_output(const void *data, uint32_t len, uint64_t ready_ns)
+{
+    if (g_out_len + len > g_out_cap) {
+        g_out_cap = (g_out_len + len) * 2 + 4096;
+        g_out = realloc(g_out, g_out_cap);
+    }
+    memcpy(g_out + g_out_len, data, len);
+    
+    if (g_mark_count == 0 || g_marks[g_mark_count - 1].ready_ns != ready_ns) {
+        // 已全部上线的mark不再需要
+        uint32_t keep = 0;
+        for (uint32_t i = 0; i < g_mark_count; i++) {
+            if (i + 1 < g_mark_count && g_marks[i + 1].index <= g_out_pos) {
+                continue;
+            }
+            g_marks[keep++] = g_marks[i];
+        }
+        g_mark_count = keep;
+        if (g_mark_count < EMU_MAX_MARKS) {
+            g_marks[g_mark_count].index = g_out_len;
+            g_marks[g_mark_count].ready_ns = ready_ns;
+            g_mark_count++;
+        }
+    }
+    
+    g_out_len += len;
+}
+
+static void emu_output_str(const char *str, uint64_t ready_ns)
+{
+    emu_output(str, (uint32_t)strlen(str), ready_ns);
+}
+
+/**
+ * @brief 输出位置index的字节最早上线时间
+ */
+static uint64_t emu_ready_ns(uint32_t index)
+{
+    uint64_t ready = 0;
+    for (uint32_t i = 0; i < g_mark_count && g_marks[i].index <= index; i++) {
+        ready = g_marks[i].ready_ns;
+    }
+    return ready;
+}
+
+/**
+ * @brief AT+UART_CUR的回复发送完，模块切换波特率和流控
+ */
+static void emu_apply_uart_cur(void)
+{
+    g_module_baud = g_pending_baud;
+    g_module_flow = (g_pending_flow & 2) != 0;
+    g_pending_baud = 0;
+}
+
+/**
+ * @brief 驱动按缓冲区使用量更新RTS（与stm32_hal_wrapper.c的规则相同），
+ *        RTS恢复有效时模块从now_ns起继续发送
+ */
+static void emu_rts_update(uint64_t now_ns)
+{
+    bool pause = g_host_flow && g_module_flow &&
+                 g_ring_head - g_ring_tail > EMU_RX_RING_SIZE / 2 - UART_RTS_MARGIN;
+    
+    if (pause && !g_rts_paused) {
+        g_stats.rts_pauses++;
+    } else if (!pause && g_rts_paused && g_wire_ns < now_ns) {
+        g_wire_ns = now_ns;
+    }
+    g_rts_paused = pause;
+}
+
+/**
+ * @brief 把到当前时间为止线路上到达的字节写入接收环形缓冲区
+ */
+static void emu_update(void)
+{
+    uint64_t now = emu_now_ns();
+    
+    while (g_out_pos < g_out_len && !g_rts_paused) {
+        if (g_pending_baud != 0 && g_out_pos >= g_pending_baud_at) {
+            emu_apply_uart_cur();
+        }
+        
+        uint64_t byte_ns = emu_byte_ns(g_module_baud);
+        uint64_t start = emu_ready_ns(g_out_pos);
+        if (start < g_wire_ns) {
+            start = g_wire_ns;
+        }
+        if (start + byte_ns > now) {
+            break;
+        }
+        
+        uint8_t byte = g_out[g_out_pos++];
+        g_wire_ns = start + byte_ns;
+        
+        // 波特率不一致或超出链路能力时收到的是错误的字节
+        if (g_host_baud != g_module_baud) {
+            byte ^= 0x5A;
+        } else if (g_config.max_baudrate != 0 && g_module_baud > g_config.max_baudrate) {
+            byte ^= 0x10;
+        }
+        
+        g_ring[g_ring_head % EMU_RX_RING_SIZE] = byte;
+        g_ring_head++;
+        g_uart_stats.rx_bytes++;
+        g_stats.bytes_to_host++;
+        
+        // 缓冲区已满，最旧的数据被DMA覆盖
+        if (g_ring_head - g_ring_tail > EMU_RX_RING_SIZE) {
+            g_uart_stats.rx_overruns += g_ring_head - g_ring_tail - EMU_RX_RING_SIZE;
+            g_ring_tail = g_ring_head - EMU_RX_RING_SIZE;
+        }
+        
+        // DMA半满/全满中断
+        if (g_ring_head % (EMU_RX_RING_SIZE / 2) == 0) {
+            emu_rts_update(g_wire_ns);
+        }
+    }
+    
+    if (g_out_pos == g_out_len && g_pending_baud != 0) {
+        emu_apply_uart_cur();
+    }
+    
+    emu_rts_update(now);
+}
+
+// ==================== HTTP服务器 ====================
+
+/**
+ * @brief 在请求中查找头字段（不区分大小写），返回值的起始位置
+ */
+static const char *emu_find_header(const char *request, const char *name)
+{
+    size_t name_len = strlen(name);
+    
+    for (const char *line = strstr(request, "\r\n"); line != NULL; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *value = line + name_len + 1;
+            while (*value == ' ') {
+                value++;
+            }
+            return value;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 处理一个HTTP请求，生成响应（服务器发送完后关闭连接）
+ * @param passthrough 透传模式（不加+IPD帧头，不上报CLOSED）
+ */
+static void emu_http_request(const char *request, uint64_t ready_ns, bool passthrough)
+{
+    static char header[512];
+    uint32_t start = 0;
+    uint16_t status = 200;
+    
+    g_stats.requests++;
+    if (passthrough) {
+        g_stats.passthrough_requests++;
+    }
+    
+    const char *range = emu_find_header(request, "Range");
+    const char *if_range = emu_find_header(request, "If-Range");
+    g_stats.range_start = range ? (uint32_t)strtoul(range + strlen("bytes="), NULL, 10) : 0;
+    g_stats.if_range = (if_range != NULL);
+    
+    int len;
+    if (g_server.redirect && !g_redirected) {
+        g_redirected = true;
+        status = 302;
+        len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 302 Found\r\nLocation: %s\r\nContent-Length: 0\r\n"
+                       "Connection: close\r\n\r\n", g_server.redirect);
+    } else {
+        size_t etag_len = g_server.etag ? strlen(g_server.etag) : 0;
+        bool etag_match = (if_range == NULL) ||
+                          (g_server.etag && strncmp(if_range, g_server.etag, etag_len) == 0 &&
+                           if_range[etag_len] == '\r');
+        
+        if (range && g_server.range && etag_match && g_stats.range_start < g_server.body_len) {
+            status = 206;
+            start = g_stats.range_start;
+        }
+        
+        len = snprintf(header, sizeof(header), "HTTP/1.1 %u %s\r\nServer: emu\r\n",
+                       status, status == 206 ? "Partial Content" : "OK");
+        if (g_server.etag) {
+            len += snprintf(header + len, sizeof(header) - len, "ETag: %s\r\n", g_server.etag);
+        }
+        if (status == 206) {
+            len += snprintf(header + len, sizeof(header) - len,
+                            "Content-Range: bytes %lu-%lu/%lu\r\n", (unsigned long)start,
+                            (unsigned long)(g_server.body_len - 1), (unsigned long)g_server.body_len);
+        }
+        if (g_server.chunked) {
+            len += snprintf(header + len, sizeof(header) - len, "Transfer-Encoding: chunked\r\n");
+        } else {
+            len += snprintf(header + len, sizeof(header) - len, "Content-Length: %lu\r\n",
+                            (unsigned long)(g_server.body_len - start));
+        }
+        len += snprintf(header + len, sizeof(header) - len, "Connection: close\r\n\r\n");
+    }
+    g_stats.status_code = status;
+    
+    // 响应（响应头+编码后的响应体）
+    uint32_t body_len = (status == 302) ? 0 : g_server.body_len - start;
+    uint8_t *resp = malloc(len + body_len * 2 + 64);
+    uint32_t resp_len = (uint32_t)len;
+    memcpy(resp, header, len);
+    
+    if (g_server.chunked && status != 302) {
+        uint32_t chunk_size = g_server.chunk_size ? g_server.chunk_size : 1000;
+        for (uint32_t off = 0; off < body_len; off += chunk_size) {
+            uint32_t n = (body_len - off < chunk_size) ? body_len - off : chunk_size;
+            resp_len += sprintf((char *)resp + resp_len, "%lx\r\n", (unsigned long)n);
+            memcpy(resp + resp_len, g_server.body + start + off, n);
+            resp_len += n;
+            resp_len += sprintf((char *)resp + resp_len, "\r\n");
+        }
+        resp_len += sprintf((char *)resp + resp_len, "0\r\n\r\n");
+    } else if (body_len > 0) {
+        memcpy(resp + resp_len, g_server.body + start, body_len);
+        resp_len += body_len;
+    }
+    
+    // 连接中途断开
+    if (g_drops_left > 0 && g_server.drop_after > 0 && status != 302 &&
+        resp_len > (uint32_t)len + g_server.drop_after) {
+        resp_len = (uint32_t)len + g_server.drop_after;
+        g_drops_left--;
+    }
+    
+    if (passthrough) {
+        emu_output(resp, resp_len, ready_ns);
+    } else {
+        uint32_t ipd_size = g_config.ipd_size ? g_config.ipd_size : 1460;
+        for (uint32_t off = 0; off < resp_len; off += ipd_size) {
+            uint32_t n = (resp_len - off < ipd_size) ? resp_len - off : ipd_size;
+            char frame[24];
+            snprintf(frame, sizeof(frame), "\r\n+IPD,%lu:", (unsigned long)n);
+            emu_output_str(frame, ready_ns);
+            emu_output(resp + off, n, ready_ns);
+        }
+        emu_output_str("CLOSED\r\n", ready_ns);
+    }
+    
+    g_connected = false;
+    free(resp);
+}
+
+// ==================== AT命令 ====================
+
+/**
+ * @brief 执行一行AT命令
+ */
+static void emu_command(const char *cmd, uint64_t ready_ns)
+{
+    uint64_t latency_ns = (uint64_t)(g_config.latency_ms ? g_config.latency_ms : 30) * 1000000;
+    unsigned long baud, flow;
+    
+    if (g_echo) {
+        emu_output_str(cmd, ready_ns);
+        emu_output_str("\r\r\n", ready_ns);
+    }
+    
+    if (strcmp(cmd, "AT") == 0) {
+        emu_output_str("\r\nOK\r\n", ready_ns);
+    } else if (strcmp(cmd, "ATE0") == 0 || strcmp(cmd, "ATE1") == 0) {
+        g_echo = (cmd[3] == '1');
+        emu_output_str("\r\nOK\r\n", ready_ns);
+    } else if (strcmp(cmd, "AT+GMR") == 0) {
+        emu_output_str("AT version:1.7.4.0(May 11 2020 19:13:04)\r\n"
+                       "SDK version:3.0.4(9532ceb)\r\n"
+                       "compile time:May 27 2020 10:12:22\r\n"
+                       "Bin version(Wroom 02):1.7.4\r\n\r\nOK\r\n", ready_ns);
+    } else if (sscanf(cmd, "AT+UART_CUR=%lu,8,1,0,%lu", &baud, &flow) == 2) {
+        if (baud < 110 || baud > 4500000 || flow > 3) {
+            emu_output_str("\r\nERROR\r\n", ready_ns);
+            return;
+        }
+        emu_output_str("\r\nOK\r\n", ready_ns);
+        g_stats.uart_changes++;
+        g_pending_baud = (uint32_t)baud;
+        g_pending_flow = (uint32_t)flow;
+        g_pending_baud_at = g_out_len;
+    } else if (strncmp(cmd, "AT+CIPMODE=", 11) == 0) {
+        g_cipmode = (cmd[11] == '1');
+        emu_output_str("\r\nOK\r\n", ready_ns);
+    } else if (strncmp(cmd, "AT+CIPSTART=\"TCP\",", 18) == 0) {
+        if (g_connected) {
+            emu_output_str("ALREADY CONNECTED\r\n\r\nERROR\r\n", ready_ns);
+            return;
+        }
+        g_connected = true;
+        g_stats.connections++;
+        emu_output_str("CONNECT\r\n\r\nOK\r\n", ready_ns + latency_ns);
+    } else if (strncmp(cmd, "AT+CIPSEND=", 11) == 0) {
+        if (!g_connected || g_cipmode) {
+            emu_output_str("link is not valid\r\n\r\nERROR\r\n", ready_ns);
+            return;
+        }
+        g_send_remaining = (uint32_t)strtoul(cmd + 11, NULL, 10);
+        g_input = EMU_INPUT_SEND;
+        g_line_len = 0;
+        emu_output_str("\r\nOK\r\n> ", ready_ns);
+    } else if (strcmp(cmd, "AT+CIPSEND") == 0) {
+        if (!g_connected || !g_cipmode) {
+            emu_output_str("\r\nERROR\r\n", ready_ns);
+            return;
+        }
+        g_input = EMU_INPUT_PASSTHROUGH;
+        g_line_len = 0;
+        emu_output_str("\r\nOK\r\n\r\n>", ready_ns);
+    } else if (strcmp(cmd, "AT+CIPCLOSE") == 0) {
+        if (!g_connected) {
+            emu_output_str("\r\nERROR\r\n", ready_ns);
+            return;
+        }
+        g_connected = false;
+        emu_output_str("CLOSED\r\n\r\nOK\r\n", ready_ns);
+    } else {
+        emu_output_str("\r\nERROR\r\n", ready_ns);
+    }
+}
+
+/**
+ * @brief 模块收到MCU发送的数据
+ */
+static void emu_input(const uint8_t *data, uint32_t len, uint64_t ready_ns)
+{
+    uint64_t latency_ns = (uint64_t)(g_config.latency_ms ? g_config.latency_ms : 30) * 1000000;
+    bool guarded = (ready_ns - g_last_input_ns) >= 1000000000ULL;
+    
+    g_last_input_ns = ready_ns;
+    
+    // 透传模式下前后静默的"+++"退出透传
+    if (g_input == EMU_INPUT_PASSTHROUGH) {
+        if (len == 3 && memcmp(data, "+++", 3) == 0 && guarded) {
+            g_input = EMU_INPUT_COMMAND;
+            g_line_len = 0;
+            return;
+        }
+        for (uint32_t i = 0; i < len && g_line_len < sizeof(g_line) - 1; i++) {
+            g_line[g_line_len++] = (char)data[i];
+        }
+        g_line[g_line_len] = '\0';
+        if (g_connected && strstr(g_line, "\r\n\r\n") != NULL) {
+            emu_http_request(g_line, ready_ns + latency_ns, true);
+            g_line_len = 0;
+        }
+        return;
+    }
+    
+    for (uint32_t i = 0; i < len; i++) {
+        if (g_input == EMU_INPUT_SEND) {
+            if (g_line_len < sizeof(g_line) - 1) {
+                g_line[g_line_len++] = (char)data[i];
+            }
+            if (--g_send_remaining == 0) {
+                char recv[48];
+                g_line[g_line_len] = '\0';
+                snprintf(recv, sizeof(recv), "\r\nRecv %lu bytes\r\n\r\nSEND OK\r\n",
+                         (unsigned long)g_line_len);
+                emu_output_str(recv, ready_ns);
+                g_input = EMU_INPUT_COMMAND;
+                emu_http_request(g_line, ready_ns + latency_ns, false);
+                g_line_len = 0;
+            }
+            continue;
+        }
+        
+        if (data[i] == '\n') {
+            while (g_line_len > 0 && g_line[g_line_len - 1] == '\r') {
+                g_line_len--;
+            }
+            g_line[g_line_len] = '\0';
+            g_line_len = 0;
+            if (g_line[0] != '\0') {
+                emu_command(g_line, ready_ns);
+            }
+        } else if (g_line_len < sizeof(g_line) - 1) {
+            g_line[g_line_len++] = (char)data[i];
+        }
+    }
+}
+
+// ==================== 模拟器接口 ====================
+
+void esp8266_emu_init(const esp8266_emu_config_t *config)
+{
+    if (config) {
+        g_config = *config;
+    } else {
+        memset(&g_config, 0, sizeof(g_config));
+    }
+    
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_module_baud = EMU_DEFAULT_BAUDRATE;
+    g_pending_baud = 0;
+    g_module_flow = false;
+    g_echo = true;
+    g_cipmode = false;
+    g_connected = false;
+    g_input = EMU_INPUT_COMMAND;
+    g_line_len = 0;
+    g_last_input_ns = 0;
+    
+    g_out_len = 0;
+    g_out_pos = 0;
+    g_mark_count = 0;
+    g_wire_ns = emu_now_ns();
+    g_tx_done_ns = g_wire_ns;
+    
+    g_host_baud = EMU_DEFAULT_BAUDRATE;
+    g_ring_head = 0;
+    g_ring_tail = 0;
+    g_rts_paused = false;
+    memset(&g_uart_stats, 0, sizeof(g_uart_stats));
+}
+
+void esp8266_emu_set_server(const esp8266_emu_server_t *server)
+{
+    g_server = *server;
+    g_drops_left = server->drop_count;
+    g_redirected = false;
+}
+
+void esp8266_emu_get_stats(esp8266_emu_stats_t *stats)
+{
+    emu_update();
+    *stats = g_stats;
+    stats->baudrate = g_pending_baud ? g_pending_baud : g_module_baud;
+}
+
+// ==================== stm32_hal_wrapper.h UART函数 ====================
+
+int uart_init(uint8_t uart_num, uint32_t baudrate)
+{
+    if (uart_num != WIFI_UART_NUM) {
+        return 0;
+    }
+    
+    uart_flush(uart_num, 100);
+    emu_update();
+    
+    // 重新启动DMA接收，缓冲区中未读的数据丢弃
+    g_host_baud = baudrate;
+    g_ring_tail = g_ring_head;
+    emu_rts_update(emu_now_ns());
+    return 0;
+}
+
+int uart_send_string(uint8_t uart_num, const char *str)
+{
+    if (str == NULL) {
+        return -1;
+    }
+    
+    uint32_t len = (uint32_t)strlen(str);
+    if (uart_num != WIFI_UART_NUM) {
+        return (int)len;
+    }
+    
+    emu_update();
+    
+    // DMA在后台发送，数据按波特率到达模块
+    uint64_t now = emu_now_ns();
+    if (g_tx_done_ns < now) {
+        g_tx_done_ns = now;
+    }
+    g_tx_done_ns += len * emu_byte_ns(g_host_baud);
+    
+    if (g_pending_baud != 0) {
+        return (int)len;
+    }
+    if (g_host_baud == g_module_baud) {
+        emu_input((const uint8_t *)str, len, g_tx_done_ns);
+    } else {
+        // 波特率不一致：模块收到错误的字节，留在命令行缓冲区中
+        uint8_t *garbled = malloc(len);
+        for (uint32_t i = 0; i < len; i++) {
+            garbled[i] = (uint8_t)str[i] ^ 0x5A;
+        }
+        emu_input(garbled, len, g_tx_done_ns);
+        free(garbled);
+    }
+    return (int)len;
+}
+
+int uart_flush(uint8_t uart_num, uint32_t timeout_ms)
+{
+    uint64_t now = emu_now_ns();
+    
+    if (uart_num == WIFI_UART_NUM && g_tx_done_ns > now) {
+        flash_sim_advance_us((uint32_t)((g_tx_done_ns - now + 999) / 1000));
+    }
+    return 0;
+}
+
+uint32_t uart_read(uint8_t uart_num, uint8_t *buffer, uint32_t size)
+{
+    if (uart_num != WIFI_UART_NUM) {
+        return 0;
+    }
+    
+    emu_update();
+    
+    uint32_t available = g_ring_head - g_ring_tail;
+    if (available == 0) {
+        // 轮询等待数据时模拟时钟前进
+        flash_sim_advance_us(20);
+        return 0;
+    }
+    
+    if (size > available) {
+        size = available;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        buffer[i] = g_ring[(g_ring_tail + i) % EMU_RX_RING_SIZE];
+    }
+    g_ring_tail += size;
+    emu_rts_update(emu_now_ns());
+    
+    return size;
+}
+
+uint32_t uart_rx_available(uint8_t uart_num)
+{
+    if (uart_num != WIFI_UART_NUM) {
+        return 0;
+    }
+    
+    emu_update();
+    return g_ring_head - g_ring_tail;
+}
+
+uint32_t uart_rx_capacity(uint8_t uart_num)
+{
+    return (uart_num == WIFI_UART_NUM) ? EMU_RX_RING_SIZE : 0;
+}
+
+int uart_get_stats(uint8_t uart_num, uart_stats_t *stats)
+{
+    if (uart_num != WIFI_UART_NUM || stats == NULL) {
+        return -1;
+    }
+    
+    emu_update();
+    *stats = g_uart_stats;
+    return 0;
+}
+
+int uart_set_flow_control(uint8_t uart_num, bool enable)
+{
+    if (uart_num != WIFI_UART_NUM) {
+        return 0;
+    }
+    
+    emu_update();
+    g_host_flow = enable;
+    emu_rts_update(emu_now_ns());
+    return 0;
+}
+
+bool uart_get_flow_control(uint8_t uart_num)
+{
+    return uart_num == WIFI_UART_NUM && g_host_flow;
+}
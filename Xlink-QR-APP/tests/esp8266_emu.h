@@ -0,0 +1,73 @@
+/**
+ * @file esp8266_emu.h
+ * @brief 主机测试用的ESP8266模块和HTTP服务器模拟器
+ * @note 代替stm32_hal_wrapper.c的UART函数（WiFi模块UART，WIFI_UART_NUM）。
+ *       模块按AT固件的格式回复AT命令、+IPD帧和透传数据，字节按波特率
+ *       （10位/字节）在Flash模拟器的模拟时钟上到达，写入与芯片驱动相同的
+ *       接收环形缓冲区（UART3_RX_BUFFER_SIZE），CPU长时间不读取（如同步擦除、
+ *       编程）时最旧的数据被覆盖，计入uart_stats_t.rx_overruns。
+ *       MCU与模块波特率不一致时双方收到的字节都是错误的（模块收到的错误字节
+ *       留在命令行缓冲区中，直到换行）。
+ *       MCU启用流控（uart_set_flow_control）且模块用AT+UART_CUR启用CTS时，
+ *       按驱动的规则用RTS暂停模块发送。
+ */
+
+#ifndef ESP8266_EMU_H
+#define ESP8266_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 模块配置
+typedef struct {
+    uint32_t max_baudrate;       // 链路可靠的最高波特率，更高时模块发出的字节全部出错（0不限制）
+    uint32_t ipd_size;           // AT模式每个+IPD帧的最大载荷（0为1460）
+    uint32_t latency_ms;         // 连接建立和HTTP请求的往返时间（0为30ms）
+} esp8266_emu_config_t;
+
+// HTTP服务器上的资源
+typedef struct {
+    const uint8_t *body;         // 资源内容
+    uint32_t body_len;
+    const char *etag;            // ETag（含引号，NULL不发送）
+    bool chunked;                // 响应体用分块传输发送
+    uint32_t chunk_size;         // 分块大小（0为1000）
+    bool range;                  // 支持Range（If-Range与ETag不符时返回完整内容）
+    uint32_t drop_after;         // 连接发送这么多响应体字节（含分块编码）后断开（0不断开）
+    uint32_t drop_count;         // 断开的连接数，之后的连接完整发送
+    const char *redirect;        // 非NULL时第一个请求返回302到该URL
+} esp8266_emu_server_t;
+
+// 模拟统计
+typedef struct {
+    uint32_t baudrate;           // 模块当前波特率
+    uint32_t connections;        // TCP连接次数
+    uint32_t requests;           // HTTP请求次数
+    uint32_t passthrough_requests; // 其中透传模式发送的请求
+    uint32_t range_start;        // 最近一次请求的Range起点（0未请求）
+    bool if_range;               // 最近一次请求带If-Range
+    uint16_t status_code;        // 最近一次响应的状态码
+    uint32_t bytes_to_host;      // 模块发给MCU的字节数
+    uint32_t rts_pauses;         // MCU用RTS暂停模块发送的次数
+    uint32_t uart_changes;       // 执行的AT+UART_CUR命令数
+} esp8266_emu_stats_t;
+
+/**
+ * @brief 模块上电（115200波特率，普通模式，回显打开），清零统计
+ * @param config 模块配置（NULL使用默认值）
+ */
+void esp8266_emu_init(const esp8266_emu_config_t *config);
+
+/**
+ * @brief 设置HTTP服务器上的资源（所有URL返回同一资源）
+ * @param server 资源（内容指针在测试期间必须有效）
+ */
+void esp8266_emu_set_server(const esp8266_emu_server_t *server);
+
+/**
+ * @brief 获取模拟统计
+ * @param stats 统计信息（输出）
+ */
+void esp8266_emu_get_stats(esp8266_emu_stats_t *stats);
+
+#endif // ESP8266_EMU_H
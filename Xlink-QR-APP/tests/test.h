@@ -0,0 +1,73 @@
+/**
+ * @file test.h
+ * @brief 主机测试的断言宏和公共辅助函数
+ * @note 每个tests/test_*.c是一个测试程序（见Makefile的test目标），
+ *       main中用TEST_RUN逐个运行测试函数，最后返回TEST_RESULT()
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "flash_manager.h"
+
+static int g_test_failures = 0;
+
+// 条件不成立时打印位置并记为失败（继续运行）
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("    %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        g_test_failures++; \
+    } \
+} while (0)
+
+// 比较两个整数，失败时打印两边的值
+#define CHECK_EQ(a, b) do { \
+    unsigned long long va_ = (unsigned long long)(a), vb_ = (unsigned long long)(b); \
+    if (va_ != vb_) { \
+        printf("    %s:%d: CHECK_EQ(%s, %s) failed: %llu != %llu\n", \
+               __FILE__, __LINE__, #a, #b, va_, vb_); \
+        g_test_failures++; \
+    } \
+} while (0)
+
+// 比较两块内存
+#define CHECK_MEM(a, b, len) CHECK(memcmp((a), (b), (len)) == 0)
+
+// 运行一个测试函数
+#define TEST_RUN(fn) do { \
+    int before_ = g_test_failures; \
+    fn(); \
+    printf("  %-40s %s\n", #fn, g_test_failures == before_ ? "ok" : "FAILED"); \
+} while (0)
+
+// main的返回值
+#define TEST_RESULT() (g_test_failures == 0 ? 0 : 1)
+
+/**
+ * @brief 填充伪随机测试数据（同一seed得到相同内容）
+ */
+static inline void fill_pattern(uint8_t *data, uint32_t len, uint32_t seed)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/**
+ * @brief 重新打开全空白的Flash镜像并初始化Flash管理器
+ * @param image_path 镜像文件（每个测试程序使用自己的文件）
+ */
+static inline void sim_reset(const char *image_path)
+{
+    remove(image_path);
+    CHECK_EQ(flash_sim_open(image_path), 0);
+    flash_manager_init();
+}
+
+#endif // TEST_H
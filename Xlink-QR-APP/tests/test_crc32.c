@@ -0,0 +1,189 @@
+/**
+ * @file test_crc32.c
+ * @brief CRC32测试：查找表方案和CRC单元的结果与逐位计算的参考值相同，
+ *        CRC单元模型符合CRC-32/MPEG-2的定义；输出主机上的计算速度
+ * @note 直接包含crc32.c，Makefile为每种查找表方案分别在使用和不使用CRC单元时编译
+ */
+
+#include "test.h"
+#include "crc32.c"
+#include <time.h>
+
+// 吞吐量测试的轮数（每轮计算整个g_data）
+#define BENCH_ROUNDS  2000
+
+static uint8_t g_data[1500];
+
+/**
+ * @brief 参考实现：IEEE 802.3 CRC32，反射，逐位计算
+ */
+static uint32_t ref_crc32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+/**
+ * @brief 参考实现：CRC-32/MPEG-2（不反射，不取反），逐位计算
+ */
+static uint32_t ref_mpeg2(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint32_t)data[i] << 24;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief 参考实现：写入CRC_DR的一个字（高字节先进入移位寄存器）
+ */
+static uint32_t ref_unit_write(uint32_t dr, uint32_t word)
+{
+    uint8_t bytes[4] = {
+        (uint8_t)(word >> 24), (uint8_t)(word >> 16), (uint8_t)(word >> 8), (uint8_t)word
+    };
+    return ref_mpeg2(dr, bytes, 4);
+}
+
+/**
+ * @brief 按位反转（驱动写入CRC_DR前的RBIT）
+ */
+static uint32_t ref_rbit(uint32_t value)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 32; i++) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+/**
+ * @brief 标准校验值（"123456789"）
+ */
+static void test_check_value(void)
+{
+    const uint8_t *check = (const uint8_t *)"123456789";
+    
+    CHECK_EQ(calculate_crc32(check, 9), 0xCBF43926);
+    CHECK_EQ(calculate_crc32(check, 0), 0);
+    CHECK_EQ(ref_crc32(check, 9), 0xCBF43926);
+}
+
+/**
+ * @brief 每种起始对齐和长度（覆盖逐字节、slicing和CRC单元的切换点）
+ */
+static void test_alignment_and_lengths(void)
+{
+    for (uint32_t offset = 0; offset < 8; offset++) {
+        for (uint32_t len = 0; len <= 300; len++) {
+            CHECK_EQ(calculate_crc32(g_data + offset, len), ref_crc32(g_data + offset, len));
+        }
+        
+        uint32_t len = sizeof(g_data) - offset;
+        CHECK_EQ(calculate_crc32(g_data + offset, len), ref_crc32(g_data + offset, len));
+    }
+}
+
+/**
+ * @brief 分段计算与整体计算结果相同
+ */
+static void test_incremental(void)
+{
+    uint32_t len = 1000;
+    uint32_t whole = ref_crc32(g_data, len);
+    
+    for (uint32_t split = 0; split <= len; split++) {
+        uint32_t crc = calculate_crc32_update(0, g_data, split);
+        CHECK_EQ(calculate_crc32_update(crc, g_data + split, len - split), whole);
+        
+        uint32_t state = crc32_init();
+        state = crc32_update(state, g_data, split / 2);
+        state = crc32_update(state, g_data + split / 2, split - split / 2);
+        state = crc32_update(state, g_data + split, len - split);
+        CHECK_EQ(crc32_final(state), whole);
+    }
+}
+
+/**
+ * @brief CRC单元模型：复位值0xFFFFFFFF，每个字高位在前，数据字按位反转后写入
+ */
+static void test_unit_model(void)
+{
+    uint32_t words[64];
+    
+    // CRC-32/MPEG-2校验值，以及复位后写入0x12345678的CRC_DR
+    CHECK_EQ(ref_mpeg2(0xFFFFFFFF, (const uint8_t *)"123456789", 9), 0x0376E6E7);
+    CHECK_EQ(crc_unit_calc(0x12345678, NULL, 0), 0xDF8A8A2B);
+    
+    memcpy(words, g_data, sizeof(words));
+    for (uint32_t n = 0; n <= 64; n += 7) {
+        uint32_t seed = words[n % 64] ^ n;
+        uint32_t dr = ref_unit_write(0xFFFFFFFF, seed);
+        for (uint32_t i = 0; i < n; i++) {
+            dr = ref_unit_write(dr, ref_rbit(words[i]));
+        }
+        CHECK_EQ(crc_unit_calc(seed, words, n), dr);
+    }
+}
+
+#if CRC32_HW
+/**
+ * @brief 起始值：复位后写入crc32_hw_seed(x)使CRC_DR等于x
+ */
+static void test_hw_seed(void)
+{
+    uint32_t target = 0;
+    
+    for (uint32_t i = 0; i < 1000; i++) {
+        CHECK_EQ(crc_unit_calc(crc32_hw_seed(target), NULL, 0), target);
+        target = target * 1664525 + 1013904223;
+    }
+    CHECK_EQ(crc_unit_calc(crc32_hw_seed(0xFFFFFFFF), NULL, 0), 0xFFFFFFFF);
+}
+#endif
+
+/**
+ * @brief 主机上的计算速度（CRC单元为逐位模拟的寄存器模型，只反映模型的速度）
+ */
+static void test_throughput(void)
+{
+    struct timespec start, end;
+    uint32_t expected = ref_crc32(g_data, sizeof(g_data));
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        CHECK_EQ(calculate_crc32(g_data, sizeof(g_data)), expected);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    int64_t ns = (int64_t)(end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+    uint64_t us = (uint64_t)(ns / 1000);
+    printf("    table %d, CRC unit %d: %llu B/s (host)\n", CRC32_TABLE, CRC32_HW,
+           (unsigned long long)((uint64_t)sizeof(g_data) * BENCH_ROUNDS * 1000000 / (us ? us : 1)));
+}
+
+int main(void)
+{
+    fill_pattern(g_data, sizeof(g_data), 1);
+    
+    TEST_RUN(test_check_value);
+    TEST_RUN(test_alignment_and_lengths);
+    TEST_RUN(test_incremental);
+    TEST_RUN(test_unit_model);
+#if CRC32_HW
+    TEST_RUN(test_hw_seed);
+#endif
+    TEST_RUN(test_throughput);
+    
+    return TEST_RESULT();
+}
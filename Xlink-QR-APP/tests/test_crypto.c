@@ -0,0 +1,351 @@
+/**
+ * @file test_crypto.c
+ * @brief SHA-256、SHA-512（FIPS 180-4示例）和Ed25519（RFC 8032）测试向量，
+ *        分区中签名镜像的验证，以及哈希吞吐量（主机上计时）
+ */
+
+#include "test.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "ed25519.h"
+#include "firmware_sign.h"
+#include "flash_sim.h"
+#include "flash_manager.h"
+#include <time.h>
+
+#define IMAGE_PATH "test_crypto.img"
+
+// 吞吐量测试：每轮数据量和轮数
+#define BENCH_SIZE    (64 * 1024)
+#define BENCH_ROUNDS  20
+
+// 哈希测试向量
+typedef struct {
+    const char *message;
+    uint32_t repeat;             // 消息重复次数
+    const char *sha256;
+    const char *sha512;
+} hash_vector_t;
+
+static const hash_vector_t g_hash_vectors[] = {
+    { "abc", 1,
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+      "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+    { "", 1,
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+      "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" },
+    { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+      "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445" },
+    { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+      "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+      NULL,
+      "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+      "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909" },
+    { "a", 1000000,
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+      "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+      "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+};
+
+// RFC 8032 7.1 TEST 1-3
+typedef struct {
+    const char *public_key;
+    const char *message;
+    const char *signature;
+} ed25519_vector_t;
+
+static const ed25519_vector_t g_ed25519_vectors[] = {
+    { "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+      "",
+      "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+      "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b" },
+    { "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+      "72",
+      "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+      "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00" },
+    { "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+      "af82",
+      "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac"
+      "18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a" },
+};
+
+// TEST 3的密钥对1000字节消息（第i字节为i * 7 + 3）的签名
+static const char g_long_signature[] =
+    "065b9d4a3ecfd0dc8d969368cb18e53ae21869d45731a76218819f53178409ff"
+    "accc50338892b6c831ce479ded6e2521495ef53ad46d765c86425b898fc93f0e";
+
+#define LONG_MESSAGE_SIZE  1000
+
+static uint8_t g_long_message[LONG_MESSAGE_SIZE];
+
+static uint8_t g_bench_data[BENCH_SIZE];
+
+/**
+ * @brief 十六进制字符串转字节
+ * @return 字节数
+ */
+static uint32_t from_hex(const char *hex, uint8_t *out)
+{
+    uint32_t len = 0;
+    
+    for (; hex[0] && hex[1]; hex += 2) {
+        unsigned int byte;
+        sscanf(hex, "%2x", &byte);
+        out[len++] = (uint8_t)byte;
+    }
+    return len;
+}
+
+/**
+ * @brief FIPS 180-4示例：一次输入，以及按不同长度分段输入
+ */
+static void test_sha_vectors(void)
+{
+    static const uint32_t steps[] = { 1, 7, 64, 127, 1000 };
+    uint8_t expected[SHA512_DIGEST_SIZE], digest[SHA512_DIGEST_SIZE];
+    
+    for (uint32_t i = 0; i < sizeof(g_hash_vectors) / sizeof(g_hash_vectors[0]); i++) {
+        const hash_vector_t *v = &g_hash_vectors[i];
+        uint32_t len = (uint32_t)strlen(v->message);
+        
+        for (uint32_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+            sha256_ctx_t ctx256;
+            sha512_ctx_t ctx512;
+            
+            sha256_init(&ctx256);
+            sha512_init(&ctx512);
+            for (uint32_t r = 0; r < v->repeat; r++) {
+                for (uint32_t pos = 0; pos < len; pos += steps[s]) {
+                    uint32_t n = (len - pos < steps[s]) ? len - pos : steps[s];
+                    sha256_update(&ctx256, (const uint8_t *)v->message + pos, n);
+                    sha512_update(&ctx512, (const uint8_t *)v->message + pos, n);
+                }
+            }
+            
+            if (v->sha256) {
+                sha256_final(&ctx256, digest);
+                from_hex(v->sha256, expected);
+                CHECK_MEM(digest, expected, SHA256_DIGEST_SIZE);
+            }
+            sha512_final(&ctx512, digest);
+            from_hex(v->sha512, expected);
+            CHECK_MEM(digest, expected, SHA512_DIGEST_SIZE);
+            
+            // 重复的单字节消息分段方式不变，只计算一次
+            if (v->repeat > 1) {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 跨越块边界的每种分段方式与一次输入结果相同
+ */
+static void test_sha_split(void)
+{
+    uint8_t whole256[SHA256_DIGEST_SIZE], whole512[SHA512_DIGEST_SIZE];
+    uint8_t digest[SHA512_DIGEST_SIZE];
+    uint32_t len = 300;
+    
+    CHECK_EQ(calculate_sha256(g_long_message, len, whole256), 0);
+    sha512_ctx_t ctx512;
+    sha512_init(&ctx512);
+    sha512_update(&ctx512, g_long_message, len);
+    sha512_final(&ctx512, whole512);
+    
+    for (uint32_t split = 0; split <= len; split++) {
+        sha256_ctx_t ctx256;
+        sha256_init(&ctx256);
+        sha256_update(&ctx256, g_long_message, split);
+        sha256_update(&ctx256, g_long_message + split, len - split);
+        sha256_final(&ctx256, digest);
+        CHECK_MEM(digest, whole256, SHA256_DIGEST_SIZE);
+        
+        sha512_init(&ctx512);
+        sha512_update(&ctx512, g_long_message, split);
+        sha512_update(&ctx512, g_long_message + split, len - split);
+        sha512_final(&ctx512, digest);
+        CHECK_MEM(digest, whole512, SHA512_DIGEST_SIZE);
+    }
+}
+
+/**
+ * @brief RFC 8032测试向量，以及分段输入的长消息
+ */
+static void test_ed25519_vectors(void)
+{
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE];
+    uint8_t signature[ED25519_SIGNATURE_SIZE];
+    uint8_t message[8];
+    
+    for (uint32_t i = 0; i < sizeof(g_ed25519_vectors) / sizeof(g_ed25519_vectors[0]); i++) {
+        const ed25519_vector_t *v = &g_ed25519_vectors[i];
+        from_hex(v->public_key, public_key);
+        from_hex(v->signature, signature);
+        uint32_t len = from_hex(v->message, message);
+        CHECK_EQ(ed25519_verify(signature, public_key, message, len), 0);
+    }
+    
+    // 固件按Flash读取粒度分段输入
+    from_hex(g_ed25519_vectors[2].public_key, public_key);
+    from_hex(g_long_signature, signature);
+    CHECK_EQ(ed25519_verify(signature, public_key, g_long_message, LONG_MESSAGE_SIZE), 0);
+    
+    ed25519_verify_ctx_t ctx;
+    ed25519_verify_init(&ctx, signature, public_key);
+    for (uint32_t pos = 0; pos < LONG_MESSAGE_SIZE; pos += 129) {
+        uint32_t n = (LONG_MESSAGE_SIZE - pos < 129) ? LONG_MESSAGE_SIZE - pos : 129;
+        ed25519_verify_update(&ctx, g_long_message + pos, n);
+    }
+    CHECK_EQ(ed25519_verify_final(&ctx), 0);
+}
+
+/**
+ * @brief 消息、R、S或公钥任何一位改变都验证失败；S >= L（S + L）被拒绝
+ */
+static void test_ed25519_rejects(void)
+{
+    static const char s_plus_l[] =
+        "f52db7415978abc61b2c2eb6aeebfca0387b2eaeb4302aeeb00d291612bb0c10";
+    const ed25519_vector_t *v = &g_ed25519_vectors[1];
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE];
+    uint8_t signature[ED25519_SIGNATURE_SIZE];
+    uint8_t message[8];
+    
+    from_hex(v->public_key, public_key);
+    from_hex(v->signature, signature);
+    uint32_t len = from_hex(v->message, message);
+    
+    message[0] ^= 0x01;
+    CHECK(ed25519_verify(signature, public_key, message, len) != 0);
+    message[0] ^= 0x01;
+    
+    for (uint32_t bit = 0; bit < ED25519_SIGNATURE_SIZE * 8; bit += 37) {
+        signature[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        CHECK(ed25519_verify(signature, public_key, message, len) != 0);
+        signature[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    }
+    
+    public_key[5] ^= 0x40;
+    CHECK(ed25519_verify(signature, public_key, message, len) != 0);
+    public_key[5] ^= 0x40;
+    
+    from_hex(s_plus_l, signature + 32);
+    CHECK(ed25519_verify(signature, public_key, message, len) != 0);
+}
+
+/**
+ * @brief 分区中的签名镜像：从Flash原地验证；镜像、签名块或长度不符时失败
+ */
+static void test_firmware_signature(void)
+{
+    static uint8_t image[LONG_MESSAGE_SIZE + sizeof(firmware_signature_t)];
+    uint8_t public_key[ED25519_PUBLIC_KEY_SIZE];
+    firmware_signature_t trailer;
+    uint32_t total = sizeof(image);
+    
+    sim_reset(IMAGE_PATH);
+    
+    from_hex(g_ed25519_vectors[2].public_key, public_key);
+    from_hex(g_long_signature, trailer.signature);
+    trailer.magic = FIRMWARE_SIGNATURE_MAGIC;
+    trailer.image_size = LONG_MESSAGE_SIZE;
+    
+    memcpy(image, g_long_message, LONG_MESSAGE_SIZE);
+    memcpy(image + LONG_MESSAGE_SIZE, &trailer, sizeof(trailer));
+    
+    CHECK_EQ(flash_erase_partition(PARTITION_B), 0);
+    CHECK_EQ(flash_write_partition(PARTITION_B, 0, image, total, NULL), 0);
+    CHECK(firmware_verify_signature(PARTITION_B, total, public_key));
+    
+    // 长度与签名块不符
+    CHECK(!firmware_verify_signature(PARTITION_B, total + 2, public_key));
+    CHECK(!firmware_verify_signature(PARTITION_B, sizeof(trailer), public_key));
+    
+    // 没有写入签名块的分区
+    CHECK_EQ(flash_erase_partition(PARTITION_A), 0);
+    CHECK(!firmware_verify_signature(PARTITION_A, total, public_key));
+    
+    // 镜像中一个字节被改写
+    image[500] ^= 0x01;
+    CHECK_EQ(flash_write_partition_diff(PARTITION_B, 0, image, FLASH_PAGE_SIZE, NULL), 0);
+    CHECK(!firmware_verify_signature(PARTITION_B, total, public_key));
+    
+    // 恢复后重新有效
+    image[500] ^= 0x01;
+    CHECK_EQ(flash_write_partition_diff(PARTITION_B, 0, image, FLASH_PAGE_SIZE, NULL), 0);
+    CHECK(firmware_verify_signature(PARTITION_B, total, public_key));
+    
+    flash_sim_close();
+    remove(IMAGE_PATH);
+}
+
+/**
+ * @brief 主机单调时钟（微秒）
+ */
+static uint64_t bench_now_us(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief SHA-256和SHA-512的吞吐量（每轮BENCH_SIZE字节一次输入，各轮结果相同）
+ */
+static void test_sha_throughput(void)
+{
+    uint8_t first[SHA512_DIGEST_SIZE], digest[SHA512_DIGEST_SIZE];
+    sha512_ctx_t ctx512;
+    
+    uint64_t start_us = bench_now_us();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        CHECK_EQ(calculate_sha256(g_bench_data, BENCH_SIZE, round ? digest : first), 0);
+        if (round) {
+            CHECK_MEM(digest, first, SHA256_DIGEST_SIZE);
+        }
+    }
+    uint64_t sha256_us = bench_now_us() - start_us;
+    
+    start_us = bench_now_us();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        sha512_init(&ctx512);
+        sha512_update(&ctx512, g_bench_data, BENCH_SIZE);
+        sha512_final(&ctx512, round ? digest : first);
+        if (round) {
+            CHECK_MEM(digest, first, SHA512_DIGEST_SIZE);
+        }
+    }
+    uint64_t sha512_us = bench_now_us() - start_us;
+    
+    uint64_t total = (uint64_t)BENCH_SIZE * BENCH_ROUNDS;
+    printf("    %u x %u bytes: SHA-256 %llu B/s, SHA-512 %llu B/s (host)\n",
+           BENCH_ROUNDS, BENCH_SIZE,
+           (unsigned long long)(total * 1000000 / (sha256_us ? sha256_us : 1)),
+           (unsigned long long)(total * 1000000 / (sha512_us ? sha512_us : 1)));
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < LONG_MESSAGE_SIZE; i++) {
+        g_long_message[i] = (uint8_t)(i * 7 + 3);
+    }
+    for (uint32_t i = 0; i < BENCH_SIZE; i++) {
+        g_bench_data[i] = (uint8_t)(i * 13 + 5);
+    }
+    
+    TEST_RUN(test_sha_vectors);
+    TEST_RUN(test_sha_split);
+    TEST_RUN(test_ed25519_vectors);
+    TEST_RUN(test_ed25519_rejects);
+    TEST_RUN(test_firmware_signature);
+    TEST_RUN(test_sha_throughput);
+    
+    return TEST_RESULT();
+}
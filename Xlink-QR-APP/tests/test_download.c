@@ -0,0 +1,533 @@
+/**
+ * @file test_download.c
+ * @brief 固件下载测试：通过模拟的ESP8266下载到Flash分区，断点续传、分块传输、重定向
+ */
+
+#include "test.h"
+#include "esp8266_emu.h"
+#include "flash_sim.h"
+#include "flash_manager.h"
+#include "firmware_download.h"
+#include "meta_store.h"
+#include "http_client.h"
+#include "at_engine.h"
+#include "sha256.h"
+#include "stm32_hal_wrapper.h"
+#include "config.h"
+
+#define IMAGE_PATH "test_download.img"
+#define URL        "http://fw.example.com/app.bin"
+
+#define FIRMWARE_SIZE  (20 * 1024 + 300)
+
+static uint8_t g_firmware[FIRMWARE_SIZE];
+static uint8_t g_firmware_v2[FIRMWARE_SIZE];
+
+// 吞吐量测试的响应体（不写入Flash）
+#define BENCH_SIZE  (64 * 1024)
+
+static uint8_t g_bench_body[BENCH_SIZE];
+
+// 吞吐量测试的接收端
+typedef struct {
+    uint32_t received;
+    uint64_t last_us;            // 收到最后一段数据的模拟时间
+} bench_sink_t;
+
+/**
+ * @brief 空白Flash，模块上电，初始化下载模块
+ * @param max_baudrate 链路可靠的最高波特率（0不限制）
+ * @param baudrate 预期协商结果
+ */
+static void setup_link(http_mode_t mode, uint32_t max_baudrate, uint32_t baudrate)
+{
+    esp8266_emu_config_t config = { 0 };
+    esp8266_emu_stats_t stats;
+    
+    sim_reset(IMAGE_PATH);
+    
+    config.max_baudrate = max_baudrate;
+    esp8266_emu_init(&config);
+    firmware_download_init(NULL);
+    CHECK_EQ(http_client_set_mode(mode), 0);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.baudrate, baudrate);
+}
+
+/**
+ * @brief 模块在115200以上不可靠，协商退回115200
+ */
+static void setup(http_mode_t mode)
+{
+    setup_link(mode, 115200, 115200);
+}
+
+/**
+ * @brief 不经协商直接把模块和UART切换到指定波特率（没有流控）
+ */
+static void force_baudrate(uint32_t baudrate)
+{
+    char cmd[48];
+    
+    snprintf(cmd, sizeof(cmd), "AT+UART_CUR=%lu,8,1,0,0", (unsigned long)baudrate);
+    CHECK_EQ(at_engine_exec(cmd, "OK", 1000), 0);
+    delay_ms(20);
+    uart_init(WIFI_UART_NUM, baudrate);
+}
+
+/**
+ * @brief 设置服务器上的资源
+ */
+static void serve(const uint8_t *body, const char *etag, bool chunked, bool range,
+                  uint32_t drop_after, uint32_t drop_count)
+{
+    esp8266_emu_server_t server = { 0 };
+    
+    server.body = body;
+    server.body_len = FIRMWARE_SIZE;
+    server.etag = etag;
+    server.chunked = chunked;
+    server.chunk_size = 700;
+    server.range = range;
+    server.drop_after = drop_after;
+    server.drop_count = drop_count;
+    esp8266_emu_set_server(&server);
+}
+
+/**
+ * @brief 下载到B分区，检查Flash内容、CRC和SHA-256
+ */
+static void download_and_check(const uint8_t *expected)
+{
+    uint32_t size = 0, crc = 0;
+    uint8_t digest[SHA256_DIGEST_SIZE], expected_digest[SHA256_DIGEST_SIZE];
+    
+    CHECK_EQ(firmware_download_to_partition(URL, PARTITION_B, &size, &crc, NULL, NULL), 0);
+    CHECK_EQ(size, FIRMWARE_SIZE);
+    CHECK_EQ(crc, calculate_crc32(expected, FIRMWARE_SIZE));
+    CHECK_MEM((const void *)(uintptr_t)APP_B_BASE_ADDR, expected, FIRMWARE_SIZE);
+    
+    CHECK_EQ(firmware_download_get_sha256(digest), 0);
+    calculate_sha256(expected, FIRMWARE_SIZE, expected_digest);
+    CHECK_MEM(digest, expected_digest, SHA256_DIGEST_SIZE);
+    
+    // 完成后不留断点
+    CHECK(!firmware_download_has_session(PARTITION_B));
+}
+
+/**
+ * @brief AT模式（+IPD帧）下载，带Content-Length
+ */
+static void test_at_mode(void)
+{
+    esp8266_emu_stats_t stats;
+    
+    setup(HTTP_MODE_AT_COMMAND);
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, 1);
+    CHECK_EQ(stats.passthrough_requests, 0);
+    CHECK_EQ(stats.status_code, 200);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 透传模式下载，分块传输
+ */
+static void test_passthrough_chunked(void)
+{
+    esp8266_emu_stats_t stats;
+    
+    setup(HTTP_MODE_AT_PASSTHROUGH);
+    serve(g_firmware, NULL, true, false, 0, 0);
+    download_and_check(g_firmware);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, 1);
+    CHECK_EQ(stats.passthrough_requests, 1);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 连接中途断开：从最近的断点（DOWNLOAD_PROGRESS_PAGES页的整数倍）用Range续传
+ */
+static void test_resume(http_mode_t mode, bool chunked)
+{
+    esp8266_emu_stats_t stats;
+    
+    setup(mode);
+    serve(g_firmware, "\"v1\"", chunked, true, 9000, 1);
+    download_and_check(g_firmware);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, 2);
+    CHECK_EQ(stats.status_code, 206);
+    CHECK_EQ(stats.range_start, 2 * DOWNLOAD_PROGRESS_PAGES * FLASH_PAGE_SIZE);
+    CHECK(stats.if_range);
+    
+    flash_sim_close();
+}
+
+static void test_resume_at_mode(void)
+{
+    test_resume(HTTP_MODE_AT_COMMAND, false);
+}
+
+static void test_resume_passthrough(void)
+{
+    test_resume(HTTP_MODE_AT_PASSTHROUGH, false);
+}
+
+/**
+ * @brief 续传请求收到分块传输的206响应
+ */
+static void test_resume_chunked_206(void)
+{
+    test_resume(HTTP_MODE_AT_COMMAND, true);
+}
+
+/**
+ * @brief 续传请求收到分块传输的200完整响应（服务器不支持Range）：从头重新写入
+ */
+static void test_resume_chunked_200(void)
+{
+    esp8266_emu_stats_t stats;
+    
+    setup(HTTP_MODE_AT_COMMAND);
+    serve(g_firmware, "\"v1\"", true, false, 9000, 1);
+    download_and_check(g_firmware);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, 2);
+    CHECK_EQ(stats.status_code, 200);
+    CHECK(stats.range_start > 0);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 所有重试都断开后重启：断点保存在Flash中，重启后续传；
+ *        资源已变化（ETag不同）时服务器返回完整的新内容
+ */
+static void test_resume_after_reboot(void)
+{
+    esp8266_emu_stats_t stats;
+    uint32_t size = 0, crc = 0;
+    
+    setup(HTTP_MODE_AT_COMMAND);
+    serve(g_firmware, "\"v1\"", false, true, 5000, MAX_DOWNLOAD_RETRIES + 1);
+    CHECK(firmware_download_to_partition(URL, PARTITION_B, &size, &crc, NULL, NULL) != 0);
+    CHECK(firmware_download_has_session(PARTITION_B));
+    
+    // 重启后同一资源：续传（每次尝试推进一个断点间隔）
+    flash_manager_init();
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.status_code, 206);
+    CHECK_EQ(stats.range_start, (MAX_DOWNLOAD_RETRIES + 1) * DOWNLOAD_PROGRESS_PAGES * FLASH_PAGE_SIZE);
+    
+    // 再次中断后资源变化：If-Range不匹配，从头下载新内容
+    serve(g_firmware_v2, "\"v1\"", false, true, 5000, MAX_DOWNLOAD_RETRIES + 1);
+    CHECK(firmware_download_to_partition(URL, PARTITION_B, &size, &crc, NULL, NULL) != 0);
+    flash_manager_init();
+    serve(g_firmware_v2, "\"v2\"", true, true, 0, 0);
+    download_and_check(g_firmware_v2);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.status_code, 200);
+    CHECK(stats.if_range);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 重定向到另一个URL
+ */
+static void test_redirect(void)
+{
+    esp8266_emu_server_t server = { 0 };
+    esp8266_emu_stats_t stats;
+    
+    setup(HTTP_MODE_AT_PASSTHROUGH);
+    server.body = g_firmware;
+    server.body_len = FIRMWARE_SIZE;
+    server.redirect = "http://cdn.example.com/app.bin";
+    esp8266_emu_set_server(&server);
+    download_and_check(g_firmware);
+    
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.connections, 2);
+    CHECK_EQ(stats.status_code, 200);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 覆盖已有固件的下载：每个重写的页计一次擦除，下载结束时保存，重启后保留
+ */
+static void test_download_wear(void)
+{
+    flash_wear_stats_t wear;
+    uint32_t pages = (FIRMWARE_SIZE + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    
+    setup(HTTP_MODE_AT_COMMAND);
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    CHECK_EQ(flash_get_wear_stats(PARTITION_B, &wear), 0);
+    CHECK_EQ(wear.total_erases, 0);
+    
+    serve(g_firmware_v2, "\"v2\"", false, true, 0, 0);
+    download_and_check(g_firmware_v2);
+    
+    flash_manager_init();
+    CHECK_EQ(flash_get_wear_stats(PARTITION_B, &wear), 0);
+    CHECK_EQ(wear.total_erases, pages);
+    CHECK_EQ(wear.max_erases, 1);
+    CHECK_EQ(wear.min_erases, 0);
+    CHECK_EQ(flash_get_page_erase_count(APP_B_BASE_ADDR + (pages - 1) * FLASH_PAGE_SIZE), 1);
+    CHECK_EQ(flash_get_page_erase_count(APP_B_BASE_ADDR + pages * FLASH_PAGE_SIZE), 0);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 没有流控时强制使用921600波特率：Flash擦除、编程期间接收缓冲区溢出，
+ *        每次尝试发现溢出都中止，不完整的数据不会被当作下载成功
+ */
+static void test_overrun_detected(http_mode_t mode)
+{
+    esp8266_emu_stats_t stats;
+    uart_stats_t uart_stats;
+    uint32_t size = 0, crc = 0;
+    
+    setup_link(mode, 0, 115200);
+    force_baudrate(921600);
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    CHECK(firmware_download_to_partition(URL, PARTITION_B, &size, &crc, NULL, NULL) != 0);
+    
+    CHECK_EQ(uart_get_stats(WIFI_UART_NUM, &uart_stats), 0);
+    CHECK(uart_stats.rx_overruns > 0);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, MAX_DOWNLOAD_RETRIES + 1);
+    
+    flash_sim_close();
+}
+
+static void test_overrun_at_mode(void)
+{
+    test_overrun_detected(HTTP_MODE_AT_COMMAND);
+}
+
+static void test_overrun_passthrough(void)
+{
+    test_overrun_detected(HTTP_MODE_AT_PASSTHROUGH);
+}
+
+/**
+ * @brief 921600波特率启用RTS/CTS流控：Flash操作期间用RTS暂停模块，不丢数据
+ */
+static void test_flow_control(http_mode_t mode)
+{
+    esp8266_emu_stats_t stats;
+    uart_stats_t uart_stats;
+    
+    uart_set_flow_control(WIFI_UART_NUM, true);
+    setup_link(mode, 0, 921600);
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    
+    CHECK_EQ(uart_get_stats(WIFI_UART_NUM, &uart_stats), 0);
+    CHECK_EQ(uart_stats.rx_overruns, 0);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.requests, 1);
+    CHECK(stats.rts_pauses > 0);
+    
+    uart_set_flow_control(WIFI_UART_NUM, false);
+    flash_sim_close();
+}
+
+static void test_flow_control_at_mode(void)
+{
+    test_flow_control(HTTP_MODE_AT_COMMAND);
+}
+
+static void test_flow_control_passthrough(void)
+{
+    test_flow_control(HTTP_MODE_AT_PASSTHROUGH);
+}
+
+/**
+ * @brief 没有流控时（默认配置）不协商：2KB接收缓冲区容纳不下最长停顿内
+ *        最低候选波特率（230400）的数据，保持115200
+ */
+static void test_negotiate_no_flow_control(void)
+{
+    esp8266_emu_stats_t stats;
+    
+    setup_link(HTTP_MODE_AT_COMMAND, 0, 115200);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.uart_changes, 0);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 921600不可靠：恢复到115200后降一级成功
+ */
+static void test_negotiate_fallback(void)
+{
+    esp8266_emu_stats_t stats;
+    
+    uart_set_flow_control(WIFI_UART_NUM, true);
+    setup_link(HTTP_MODE_AT_PASSTHROUGH, 460800, 460800);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.uart_changes, 3);
+    
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    
+    uart_set_flow_control(WIFI_UART_NUM, false);
+    flash_sim_close();
+}
+
+/**
+ * @brief MCU单独复位时直接使用上次的波特率；模块断电后用上次的波特率
+ *        握手失败（模块收到乱码），回到默认波特率重新协商
+ */
+static void test_negotiate_cached(void)
+{
+    esp8266_emu_config_t config = { 0 };
+    esp8266_emu_stats_t stats;
+    
+    uart_set_flow_control(WIFI_UART_NUM, true);
+    setup_link(HTTP_MODE_AT_PASSTHROUGH, 0, 921600);
+    
+    firmware_download_init(NULL);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.baudrate, 921600);
+    CHECK_EQ(stats.uart_changes, 1);
+    
+    esp8266_emu_init(&config);
+    firmware_download_init(NULL);
+    esp8266_emu_get_stats(&stats);
+    CHECK_EQ(stats.baudrate, 921600);
+    CHECK_EQ(stats.uart_changes, 1);
+    
+    serve(g_firmware, "\"v1\"", false, true, 0, 0);
+    download_and_check(g_firmware);
+    
+    uart_set_flow_control(WIFI_UART_NUM, false);
+    flash_sim_close();
+}
+
+/**
+ * @brief 比较响应体并记录时间
+ */
+static int bench_data_cb(const uint8_t *data, uint32_t len, void *ctx)
+{
+    bench_sink_t *sink = (bench_sink_t *)ctx;
+    flash_sim_stats_t stats;
+    
+    if (sink->received + len > BENCH_SIZE || memcmp(data, g_bench_body + sink->received, len) != 0) {
+        return -1;
+    }
+    sink->received += len;
+    flash_sim_get_stats(&stats);
+    sink->last_us = stats.time_us;
+    return 0;
+}
+
+// 吞吐量测试结果
+typedef struct {
+    uint32_t body_rate;          // 从发送请求到收到最后一个字节（字节/秒）
+    uint32_t total_rate;         // 从发送请求到下载函数返回，含关闭连接、退出透传（字节/秒）
+    uint32_t wire_bytes;         // 模块发给MCU的字节数
+} bench_result_t;
+
+/**
+ * @brief 921600波特率（流控）下接收响应体
+ * @param result 测试结果（输出）
+ */
+static void measure_throughput(http_mode_t mode, bench_result_t *result)
+{
+    esp8266_emu_server_t server = { 0 };
+    esp8266_emu_stats_t before, after;
+    flash_sim_stats_t stats;
+    bench_sink_t sink = { 0, 0 };
+    uint32_t size = 0;
+    
+    setup_link(mode, 0, 921600);
+    server.body = g_bench_body;
+    server.body_len = BENCH_SIZE;
+    esp8266_emu_set_server(&server);
+    
+    esp8266_emu_get_stats(&before);
+    flash_sim_get_stats(&stats);
+    uint64_t start_us = stats.time_us;
+    CHECK_EQ(http_client_download_stream(URL, NULL, NULL, NULL, bench_data_cb, &sink, &size, NULL), 0);
+    CHECK_EQ(sink.received, BENCH_SIZE);
+    flash_sim_get_stats(&stats);
+    esp8266_emu_get_stats(&after);
+    flash_sim_close();
+    
+    result->body_rate = (uint32_t)((uint64_t)BENCH_SIZE * 1000000 / (sink.last_us - start_us));
+    result->total_rate = (uint32_t)((uint64_t)BENCH_SIZE * 1000000 / (stats.time_us - start_us));
+    result->wire_bytes = after.bytes_to_host - before.bytes_to_host;
+}
+
+/**
+ * @brief 透传模式与AT模式（+IPD帧）的吞吐量：透传没有帧头，接收响应体略快，
+ *        但退出透传的两段静默（2 x PASSTHROUGH_GUARD_MS）使整个下载更慢
+ */
+static void test_throughput(void)
+{
+    bench_result_t at, passthrough;
+    
+    uart_set_flow_control(WIFI_UART_NUM, true);
+    measure_throughput(HTTP_MODE_AT_COMMAND, &at);
+    measure_throughput(HTTP_MODE_AT_PASSTHROUGH, &passthrough);
+    uart_set_flow_control(WIFI_UART_NUM, false);
+    
+    printf("    %u bytes: +IPD body %lu B/s, total %lu B/s (%lu bytes on UART)\n",
+           BENCH_SIZE, (unsigned long)at.body_rate, (unsigned long)at.total_rate,
+           (unsigned long)at.wire_bytes);
+    printf("    %u bytes: passthrough body %lu B/s, total %lu B/s (%lu bytes on UART)\n",
+           BENCH_SIZE, (unsigned long)passthrough.body_rate, (unsigned long)passthrough.total_rate,
+           (unsigned long)passthrough.wire_bytes);
+    CHECK(passthrough.wire_bytes < at.wire_bytes);
+    CHECK(passthrough.body_rate > at.body_rate);
+    CHECK(at.total_rate > passthrough.total_rate);
+}
+
+int main(void)
+{
+    fill_pattern(g_firmware, sizeof(g_firmware), 1);
+    fill_pattern(g_firmware_v2, sizeof(g_firmware_v2), 2);
+    fill_pattern(g_bench_body, sizeof(g_bench_body), 3);
+    
+    TEST_RUN(test_at_mode);
+    TEST_RUN(test_passthrough_chunked);
+    TEST_RUN(test_resume_at_mode);
+    TEST_RUN(test_resume_passthrough);
+    TEST_RUN(test_resume_chunked_206);
+    TEST_RUN(test_resume_chunked_200);
+    TEST_RUN(test_resume_after_reboot);
+    TEST_RUN(test_redirect);
+    TEST_RUN(test_download_wear);
+    TEST_RUN(test_overrun_at_mode);
+    TEST_RUN(test_overrun_passthrough);
+    TEST_RUN(test_flow_control_at_mode);
+    TEST_RUN(test_flow_control_passthrough);
+    TEST_RUN(test_negotiate_no_flow_control);
+    TEST_RUN(test_negotiate_fallback);
+    TEST_RUN(test_negotiate_cached);
+    TEST_RUN(test_throughput);
+    
+    remove(IMAGE_PATH);
+    return TEST_RESULT();
+}
@@ -0,0 +1,385 @@
+/**
+ * @file test_flash_sim.c
+ * @brief Flash模拟器、分区写入、擦除次数统计和分区验证测试
+ */
+
+#include "test.h"
+#include "flash_sim.h"
+#include "flash_manager.h"
+#include "meta_store.h"
+#include "crc32.h"
+#include "stm32_hal_wrapper.h"
+
+#define IMAGE_PATH "test_flash_sim.img"
+
+/**
+ * @brief 在分区每页开头写入数据，使擦除不会因空白而跳过
+ */
+static void dirty_pages(partition_t partition, uint32_t pages)
+{
+    uint32_t base_addr = flash_get_partition_base(partition);
+    
+    for (uint32_t i = 0; i < pages; i++) {
+        CHECK_EQ(flash_program_word(base_addr + i * FLASH_PAGE_SIZE, 0), 0);
+    }
+}
+
+/**
+ * @brief NOR规则：只能编程空白半字（写0x0000除外），擦除后恢复0xFF
+ */
+static void test_nor_rules(void)
+{
+    flash_sim_stats_t stats;
+    uint32_t addr = APP_A_BASE_ADDR;
+    const volatile uint16_t *flash = (const volatile uint16_t *)(uintptr_t)addr;
+    
+    sim_reset(IMAGE_PATH);
+    
+    CHECK_EQ(flash_program_word(addr, 0x12345678), 0);
+    CHECK_EQ(flash[0], 0x5678);
+    CHECK_EQ(flash[1], 0x1234);
+    
+    // 已编程的半字不能改写成其他值，内容不变
+    CHECK(flash_program_word(addr, 0x12341111) != 0);
+    CHECK_EQ(flash[0], 0x5678);
+    flash_sim_get_stats(&stats);
+    CHECK_EQ(stats.program_errors, 1);
+    
+    // 写0x0000总是允许
+    CHECK_EQ(flash_program_word(addr, 0x00000000), 0);
+    CHECK_EQ(flash[0], 0x0000);
+    
+    // 未对齐、越界
+    CHECK(flash_program_word(addr + 2, 0) != 0);
+    CHECK(flash_program_word(FLASH_SIM_BASE + FLASH_SIM_SIZE, 0) != 0);
+    
+    CHECK_EQ(flash_erase_page(addr + 100), 0);
+    CHECK_EQ(flash[0], 0xFFFF);
+    CHECK(flash_page_is_blank(addr));
+    CHECK_EQ(flash_sim_get_erase_count(addr), 1);
+    CHECK_EQ(flash_sim_get_erase_count(addr + FLASH_PAGE_SIZE), 0);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 时间模型：页擦除20ms，半字编程52us，get_system_tick返回模拟时间
+ */
+static void test_timing(void)
+{
+    flash_sim_stats_t stats;
+    uint8_t page[FLASH_PAGE_SIZE];
+    
+    sim_reset(IMAGE_PATH);
+    fill_pattern(page, sizeof(page), 1);
+    
+    CHECK_EQ(flash_erase_page(APP_B_BASE_ADDR), 0);
+    CHECK_EQ(flash_program_buffer(APP_B_BASE_ADDR, page, sizeof(page), NULL), 0);
+    
+    flash_sim_get_stats(&stats);
+    CHECK_EQ(stats.page_erases, 1);
+    CHECK_EQ(stats.halfwords_programmed, FLASH_PAGE_SIZE / 2);
+    CHECK_EQ(stats.time_us, FLASH_SIM_PAGE_ERASE_US + FLASH_PAGE_SIZE / 2 * FLASH_SIM_PROGRAM_US);
+    CHECK_EQ(get_system_tick(), stats.time_us / 1000);
+    
+    delay_ms(5);
+    CHECK_EQ(get_system_tick(), stats.time_us / 1000 + 5);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 编程失败时返回第一个不符的地址
+ */
+static void test_program_fail_addr(void)
+{
+    uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t fail_addr = 0;
+    
+    sim_reset(IMAGE_PATH);
+    fill_pattern(page, sizeof(page), 2);
+    
+    CHECK_EQ(flash_program_word(APP_A_BASE_ADDR + 100, 0x00FF00FF), 0);
+    CHECK(flash_write_partition(PARTITION_A, 0, page, sizeof(page), &fail_addr) != 0);
+    CHECK_EQ(fail_addr, APP_A_BASE_ADDR + 100);
+    
+    // 失败地址之前的数据已写入
+    CHECK_MEM((const void *)(uintptr_t)APP_A_BASE_ADDR, page, 100);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 掉电：达到操作次数后擦除和编程都失败且不改变内容
+ */
+static void test_power_cut(void)
+{
+    uint8_t page[FLASH_PAGE_SIZE];
+    const uint8_t *flash = (const uint8_t *)(uintptr_t)APP_A_BASE_ADDR;
+    
+    sim_reset(IMAGE_PATH);
+    fill_pattern(page, sizeof(page), 3);
+    
+    flash_sim_power_cut(10);
+    CHECK(flash_program_buffer(APP_A_BASE_ADDR, page, sizeof(page), NULL) != 0);
+    CHECK_MEM(flash, page, 20);
+    CHECK_EQ(flash[20], 0xFF);
+    CHECK(flash_erase_page(APP_A_BASE_ADDR) != 0);
+    CHECK_MEM(flash, page, 20);
+    
+    // 重新上电
+    flash_sim_power_cut(-1);
+    CHECK_EQ(flash_erase_page(APP_A_BASE_ADDR), 0);
+    CHECK_EQ(flash_program_buffer(APP_A_BASE_ADDR, page, sizeof(page), NULL), 0);
+    CHECK_MEM(flash, page, sizeof(page));
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 镜像文件保存Flash内容
+ */
+static void test_image_persists(void)
+{
+    sim_reset(IMAGE_PATH);
+    CHECK_EQ(flash_program_word(APP_B_END_ADDR - 4, 0xCAFEF00D), 0);
+    flash_sim_close();
+    
+    CHECK_EQ(flash_sim_open(IMAGE_PATH), 0);
+    CHECK_EQ(*(const volatile uint32_t *)(uintptr_t)(APP_B_END_ADDR - 4), 0xCAFEF00D);
+    flash_sim_close();
+}
+
+/**
+ * @brief 差分写入：相同的页跳过，只把空白变为数据的页只编程，其他页擦除后编程
+ */
+static void test_diff_write(void)
+{
+    static uint8_t image[4 * FLASH_PAGE_SIZE];
+    flash_stats_t stats;
+    flash_sim_stats_t sim_stats;
+    
+    sim_reset(IMAGE_PATH);
+    fill_pattern(image, sizeof(image), 4);
+    
+    flash_reset_stats();
+    for (uint32_t off = 0; off < sizeof(image); off += FLASH_PAGE_SIZE) {
+        CHECK_EQ(flash_write_partition_diff(PARTITION_B, off, image + off, FLASH_PAGE_SIZE, NULL), 0);
+    }
+    flash_get_stats(&stats);
+    CHECK_EQ(stats.pages_rewritten, 4);
+    CHECK_EQ(stats.pages_erased, 0);
+    
+    // 改动第2页的一个字节：只重写这一页
+    image[FLASH_PAGE_SIZE + 7] ^= 0x5A;
+    flash_reset_stats();
+    flash_sim_reset_stats();
+    for (uint32_t off = 0; off < sizeof(image); off += FLASH_PAGE_SIZE) {
+        CHECK_EQ(flash_write_partition_diff(PARTITION_B, off, image + off, FLASH_PAGE_SIZE, NULL), 0);
+    }
+    flash_get_stats(&stats);
+    flash_sim_get_stats(&sim_stats);
+    CHECK_EQ(stats.pages_unchanged, 3);
+    CHECK_EQ(stats.pages_rewritten, 1);
+    CHECK_EQ(stats.pages_erased, 1);
+    CHECK_EQ(sim_stats.page_erases, 1);
+    CHECK_EQ(flash_sim_get_erase_count(APP_B_BASE_ADDR + FLASH_PAGE_SIZE), 1);
+    CHECK_MEM((const void *)(uintptr_t)APP_B_BASE_ADDR, image, sizeof(image));
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 擦除次数：分区最少/最多/平均，单页计数，保存后重新打开镜像仍然保留
+ */
+static void test_wear_stats(void)
+{
+    flash_wear_stats_t stats;
+    
+    sim_reset(IMAGE_PATH);
+    
+    dirty_pages(PARTITION_A, PARTITION_SIZE / FLASH_PAGE_SIZE);
+    CHECK_EQ(flash_erase_partition(PARTITION_A), PARTITION_SIZE / FLASH_PAGE_SIZE);
+    for (int i = 0; i < 3; i++) {
+        dirty_pages(PARTITION_A, 1);
+        CHECK_EQ(flash_erase_partition_range(PARTITION_A, 10, 20), 1);
+    }
+    
+    // 空白页不擦除，不计数
+    CHECK_EQ(flash_erase_partition(PARTITION_A), 0);
+    
+    CHECK_EQ(flash_get_wear_stats(PARTITION_A, &stats), 0);
+    CHECK_EQ(stats.min_erases, 1);
+    CHECK_EQ(stats.max_erases, 4);
+    CHECK_EQ(stats.total_erases, PARTITION_SIZE / FLASH_PAGE_SIZE + 3);
+    CHECK_EQ(stats.mean_erases, 1);
+    CHECK_EQ(flash_get_page_erase_count(APP_A_BASE_ADDR + 100), 4);
+    CHECK_EQ(flash_get_page_erase_count(APP_A_BASE_ADDR + FLASH_PAGE_SIZE), 1);
+    CHECK_EQ(flash_get_page_erase_count(APP_A_BASE_ADDR + FLASH_PAGE_SIZE),
+             flash_sim_get_erase_count(APP_A_BASE_ADDR + FLASH_PAGE_SIZE));
+    CHECK_EQ(flash_get_page_erase_count(FLASH_BASE_ADDR), 0);
+    CHECK(flash_get_wear_stats(PARTITION_NONE, &stats) != 0);
+    
+    CHECK_EQ(flash_get_wear_stats(PARTITION_B, &stats), 0);
+    CHECK_EQ(stats.min_erases, 0);
+    CHECK_EQ(stats.max_erases, 0);
+    CHECK_EQ(stats.total_erases, 0);
+    
+    // 直接擦除系统数据区的模块自行记录
+    uint32_t sysdata_count = flash_get_page_erase_count(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE);
+    flash_wear_note_erase(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE);
+    CHECK_EQ(flash_get_page_erase_count(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE), sysdata_count + 1);
+    
+    // 保存后重新上电，计数保留
+    CHECK_EQ(flash_wear_flush(), 0);
+    flash_sim_close();
+    CHECK_EQ(flash_sim_open(IMAGE_PATH), 0);
+    flash_manager_init();
+    CHECK_EQ(flash_get_wear_stats(PARTITION_A, &stats), 0);
+    CHECK_EQ(stats.max_erases, 4);
+    CHECK_EQ(stats.total_erases, PARTITION_SIZE / FLASH_PAGE_SIZE + 3);
+    CHECK_EQ(flash_get_page_erase_count(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE), sysdata_count + 1);
+    
+    // 未保存的计数（不超过FLASH_WEAR_FLUSH_THRESHOLD）掉电丢失
+    dirty_pages(PARTITION_B, 1);
+    CHECK_EQ(flash_erase_partition(PARTITION_B), 1);
+    CHECK_EQ(flash_get_page_erase_count(APP_B_BASE_ADDR), 1);
+    flash_manager_init();
+    CHECK_EQ(flash_get_page_erase_count(APP_B_BASE_ADDR), 0);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 擦除次数只在累计达到阈值或调用flash_wear_flush时写入一条记录
+ */
+static void test_wear_flush_threshold(void)
+{
+    flash_wear_stats_t stats;
+    
+    sim_reset(IMAGE_PATH);
+    
+    // 擦除整个分区（少于阈值）：不写入，结束时保存一条
+    dirty_pages(PARTITION_A, PARTITION_SIZE / FLASH_PAGE_SIZE);
+    CHECK_EQ(flash_erase_partition(PARTITION_A), PARTITION_SIZE / FLASH_PAGE_SIZE);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 0);
+    CHECK_EQ(flash_wear_flush(), 0);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 1);
+    
+    // 没有新的擦除：不写入
+    CHECK_EQ(flash_wear_flush(), 0);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 1);
+    
+    // 累计达到阈值的擦除操作结束时自动保存，之后没有需要保存的
+    CHECK(PARTITION_SIZE / FLASH_PAGE_SIZE < FLASH_WEAR_FLUSH_THRESHOLD);
+    dirty_pages(PARTITION_A, PARTITION_SIZE / FLASH_PAGE_SIZE);
+    CHECK_EQ(flash_erase_partition(PARTITION_A), PARTITION_SIZE / FLASH_PAGE_SIZE);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 1);
+    dirty_pages(PARTITION_B, 12);
+    CHECK_EQ(flash_erase_partition(PARTITION_B), 12);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 2);
+    CHECK_EQ(flash_wear_flush(), 0);
+    CHECK_EQ(meta_store_count(META_TAG_FLASH_WEAR), 2);
+    
+    flash_manager_init();
+    CHECK_EQ(flash_get_wear_stats(PARTITION_A, &stats), 0);
+    CHECK_EQ(stats.min_erases, 2);
+    CHECK_EQ(stats.max_erases, 2);
+    CHECK_EQ(flash_get_wear_stats(PARTITION_B, &stats), 0);
+    CHECK_EQ(stats.total_erases, 12);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 写入固件和分区信息
+ * @param padding 记录填充区CRC（false为旧格式信息）
+ */
+static void write_image(partition_t partition, uint32_t size, bool padding)
+{
+    static uint8_t image[PARTITION_SIZE];
+    partition_info_t info = { 0 };
+    
+    fill_pattern(image, size, size);
+    CHECK_EQ(flash_write_partition(partition, 0, image, size, NULL), 0);
+    
+    info.magic = PARTITION_MAGIC;
+    info.version = 1;
+    info.crc32 = calculate_crc32(image, size);
+    info.size = size;
+    info.status = PARTITION_VALID;
+    if (padding) {
+        info.padding_crc32 = flash_partition_padding_crc(partition, size);
+        info.padding_magic = PARTITION_PADDING_MAGIC;
+    }
+    CHECK_EQ(flash_write_partition_info(partition, &info), 0);
+}
+
+/**
+ * @brief 普通验证只校验info.size字节（填充区改写不影响），深度验证检测填充区改写
+ */
+static void test_verify_bounded(void)
+{
+    uint32_t size = 3000;
+    uint32_t base_addr = APP_B_BASE_ADDR;
+    
+    sim_reset(IMAGE_PATH);
+    write_image(PARTITION_B, size, true);
+    CHECK(flash_verify_partition(PARTITION_B));
+    CHECK(flash_verify_partition_deep(PARTITION_B));
+    
+    // 固件之后的第一个字
+    CHECK_EQ(flash_program_word(base_addr + size, 0), 0);
+    CHECK(flash_verify_partition(PARTITION_B));
+    CHECK(!flash_verify_partition_deep(PARTITION_B));
+    
+    // 固件的最后一个字
+    CHECK_EQ(flash_program_word(base_addr + size - 4, 0), 0);
+    CHECK(!flash_verify_partition(PARTITION_B));
+    CHECK(!flash_verify_partition_deep(PARTITION_B));
+    
+    // 旧格式信息没有填充区CRC：深度验证只校验固件
+    sim_reset(IMAGE_PATH);
+    write_image(PARTITION_B, size, false);
+    CHECK_EQ(flash_program_word(APP_B_END_ADDR - 2 * FLASH_PAGE_SIZE, 0), 0);
+    CHECK(flash_verify_partition_deep(PARTITION_B));
+    
+    // 记录的填充区CRC为0（CRC可能的值）时仍然校验
+    partition_info_t info;
+    CHECK_EQ(flash_read_partition_info(PARTITION_B, &info), 0);
+    CHECK(flash_partition_padding_crc(PARTITION_B, size) != 0);
+    info.padding_crc32 = 0;
+    info.padding_magic = PARTITION_PADDING_MAGIC;
+    CHECK_EQ(flash_write_partition_info(PARTITION_B, &info), 0);
+    CHECK(flash_verify_partition(PARTITION_B));
+    CHECK(!flash_verify_partition_deep(PARTITION_B));
+    
+    // 填充区的最后一个字（分区末尾旧格式信息之前）
+    sim_reset(IMAGE_PATH);
+    write_image(PARTITION_B, size, true);
+    CHECK_EQ(flash_program_word(APP_B_END_ADDR - sizeof(partition_info_t) - 4, 0), 0);
+    CHECK(flash_verify_partition(PARTITION_B));
+    CHECK(!flash_verify_partition_deep(PARTITION_B));
+    
+    // 大小超出分区、没有分区信息
+    CHECK_EQ(flash_partition_padding_crc(PARTITION_B, PARTITION_SIZE), 0);
+    CHECK(!flash_verify_partition(PARTITION_A));
+    
+    flash_sim_close();
+}
+
+int main(void)
+{
+    TEST_RUN(test_nor_rules);
+    TEST_RUN(test_timing);
+    TEST_RUN(test_program_fail_addr);
+    TEST_RUN(test_power_cut);
+    TEST_RUN(test_image_persists);
+    TEST_RUN(test_diff_write);
+    TEST_RUN(test_wear_stats);
+    TEST_RUN(test_wear_flush_threshold);
+    TEST_RUN(test_verify_bounded);
+    
+    remove(IMAGE_PATH);
+    return TEST_RESULT();
+}
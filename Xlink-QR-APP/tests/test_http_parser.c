@@ -0,0 +1,375 @@
+/**
+ * @file test_http_parser.c
+ * @brief 响应头解析器、分块解码器和+IPD帧解析器测试（输入在任意位置切断），
+ *        以及解码吞吐量（主机上计时）
+ */
+
+#include "test.h"
+#include "http_parser.h"
+#include "esp8266_ipd.h"
+#include <time.h>
+
+static const char g_header[] =
+    "HTTP/1.1 206 Partial Content\r\n"
+    "Server: nginx\r\n"
+    "content-length:   3000 \r\n"
+    "Content-Range: bytes 4096-7095/7096\r\n"
+    "ETag: \"5f3a-1c00\"\r\n"
+    "X-Long-Header: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r\n"
+    "Location: http://example.com/fw.bin\r\n"
+    "\r\n"
+    "BODY";
+
+// 解码输出
+typedef struct {
+    uint8_t data[512];
+    uint32_t len;
+} sink_t;
+
+static int sink_append(const uint8_t *data, uint32_t len, void *ctx)
+{
+    sink_t *sink = (sink_t *)ctx;
+    
+    if (sink->len + len > sizeof(sink->data)) {
+        return -1;
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+    return 0;
+}
+
+/**
+ * @brief 分段输入响应头
+ * @param step 每段长度（0表示在split处分为两段）
+ * @return 响应头长度（-1解析失败）
+ */
+static int parse_header(http_response_t *resp, uint32_t split, uint32_t step)
+{
+    http_header_parser_t parser;
+    const uint8_t *data = (const uint8_t *)g_header;
+    uint32_t len = sizeof(g_header) - 1;
+    uint32_t pos = 0;
+    
+    http_header_parser_init(&parser, resp);
+    while (pos < len) {
+        uint32_t n = step ? step : (pos < split ? split - pos : len - pos);
+        uint32_t consumed = 0;
+        
+        if (n > len - pos) {
+            n = len - pos;
+        }
+        int ret = http_header_parse(&parser, data + pos, n, &consumed);
+        pos += consumed;
+        if (ret == HTTP_PARSE_DONE) {
+            return (int)pos;
+        }
+        if (ret != HTTP_PARSE_NEED_MORE || consumed != n) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 响应头在每个位置切断、逐字节输入，结果与一次输入相同
+ */
+static void test_header_fragmented(void)
+{
+    http_response_t whole, part;
+    
+    CHECK_EQ(parse_header(&whole, 0, 0), sizeof(g_header) - 1 - 4);
+    CHECK_EQ(whole.status_code, 206);
+    CHECK(whole.has_content_length);
+    CHECK_EQ(whole.content_length, 3000);
+    CHECK(!whole.chunked);
+    CHECK(whole.has_content_range);
+    CHECK_EQ(whole.range_start, 4096);
+    CHECK_EQ(whole.range_end, 7095);
+    CHECK_EQ(whole.range_total, 7096);
+    CHECK(strcmp(whole.etag, "\"5f3a-1c00\"") == 0);
+    CHECK(strcmp(whole.location, "http://example.com/fw.bin") == 0);
+    
+    for (uint32_t split = 1; split < sizeof(g_header) - 1; split++) {
+        CHECK_EQ(parse_header(&part, split, 0), sizeof(g_header) - 1 - 4);
+        CHECK_MEM(&part, &whole, sizeof(whole));
+    }
+    
+    CHECK_EQ(parse_header(&part, 0, 1), sizeof(g_header) - 1 - 4);
+    CHECK_MEM(&part, &whole, sizeof(whole));
+}
+
+/**
+ * @brief Transfer-Encoding: chunked和格式错误的状态行
+ */
+static void test_header_chunked_and_errors(void)
+{
+    static const char chunked[] = "HTTP/1.0 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+    static const char bad[] = "HTTP/1.1 2x0 OK\r\n\r\n";
+    http_header_parser_t parser;
+    http_response_t resp;
+    uint32_t consumed;
+    
+    http_header_parser_init(&parser, &resp);
+    CHECK_EQ(http_header_parse(&parser, (const uint8_t *)chunked, sizeof(chunked) - 1, &consumed),
+             HTTP_PARSE_DONE);
+    CHECK_EQ(resp.status_code, 200);
+    CHECK(resp.chunked);
+    CHECK(!resp.has_content_length);
+    
+    http_header_parser_init(&parser, &resp);
+    CHECK_EQ(http_header_parse(&parser, (const uint8_t *)bad, sizeof(bad) - 1, &consumed),
+             HTTP_PARSE_ERROR);
+}
+
+/**
+ * @brief 分块编码在每个位置切断、逐字节输入，解码结果相同，结束块之后的数据不消耗
+ */
+static void test_chunk_fragmented(void)
+{
+    static const char encoded[] =
+        "5\r\nHello\r\n"
+        "1A;name=value\r\nabcdefghijklmnopqrstuvwxyz\r\n"
+        "003\r\n123\r\n"
+        "0\r\n"
+        "X-Trailer: 1\r\n"
+        "\r\n"
+        "NEXT";
+    static const char decoded[] = "Helloabcdefghijklmnopqrstuvwxyz123";
+    const uint8_t *data = (const uint8_t *)encoded;
+    uint32_t len = sizeof(encoded) - 1 - 4;
+    
+    for (uint32_t split = 0; split <= len; split++) {
+        for (uint32_t step = 0; step <= 1; step++) {
+            http_chunk_decoder_t decoder;
+            sink_t sink = { { 0 }, 0 };
+            uint32_t pos = 0;
+            int ret = HTTP_PARSE_NEED_MORE;
+            
+            http_chunk_decoder_init(&decoder);
+            while (ret == HTTP_PARSE_NEED_MORE && pos < len + 4) {
+                uint32_t n = step ? 1 : (pos < split ? split - pos : len + 4 - pos);
+                uint32_t consumed = 0;
+                ret = http_chunk_decode(&decoder, data + pos, n, sink_append, &sink, &consumed);
+                pos += consumed;
+            }
+            
+            CHECK_EQ(ret, HTTP_PARSE_DONE);
+            CHECK_EQ(pos, len);
+            CHECK_EQ(sink.len, sizeof(decoded) - 1);
+            CHECK_MEM(sink.data, decoded, sizeof(decoded) - 1);
+        }
+    }
+}
+
+/**
+ * @brief 非十六进制的分块长度
+ */
+static void test_chunk_errors(void)
+{
+    static const char bad[] = "5\r\nHello\r\nzz\r\n";
+    static const char no_crlf[] = "5\r\nHelloX\r\n";
+    http_chunk_decoder_t decoder;
+    sink_t sink = { { 0 }, 0 };
+    uint32_t consumed;
+    
+    http_chunk_decoder_init(&decoder);
+    CHECK_EQ(http_chunk_decode(&decoder, (const uint8_t *)bad, sizeof(bad) - 1,
+                               sink_append, &sink, &consumed), HTTP_PARSE_ERROR);
+    
+    http_chunk_decoder_init(&decoder);
+    CHECK_EQ(http_chunk_decode(&decoder, (const uint8_t *)no_crlf, sizeof(no_crlf) - 1,
+                               sink_append, &sink, &consumed), HTTP_PARSE_ERROR);
+}
+
+/**
+ * @brief +IPD帧在每个位置切断、逐字节输入：剥离帧头和AT响应文本，识别CLOSED
+ */
+static void test_ipd_fragmented(void)
+{
+    static const char stream[] =
+        "\r\nRecv 64 bytes\r\n\r\nSEND OK\r\n"
+        "\r\n+IPD,5:HTTP/\r\n"
+        "+IPD,0,12:1.1 200 OK\r\n"
+        "\r\n+IPD,4:+IPD"
+        "CLOSED\r\n";
+    static const char payload[] = "HTTP/1.1 200 OK\r\n+IPD";
+    const uint8_t *data = (const uint8_t *)stream;
+    uint32_t len = sizeof(stream) - 1;
+    
+    for (uint32_t split = 0; split <= len; split++) {
+        for (uint32_t step = 0; step <= 1; step++) {
+            ipd_parser_t parser;
+            sink_t sink = { { 0 }, 0 };
+            
+            ipd_parser_init(&parser);
+            for (uint32_t pos = 0; pos < len; ) {
+                uint32_t n = step ? 1 : (pos < split ? split - pos : len - pos);
+                CHECK_EQ(ipd_parser_feed(&parser, data + pos, n, sink_append, &sink), 0);
+                pos += n;
+            }
+            
+            CHECK(parser.closed);
+            CHECK_EQ(sink.len, sizeof(payload) - 1);
+            CHECK_MEM(sink.data, payload, sizeof(payload) - 1);
+        }
+    }
+}
+
+/**
+ * @brief 长度字段格式错误
+ */
+static void test_ipd_errors(void)
+{
+    static const char bad[] = "+IPD,12a:xx";
+    ipd_parser_t parser;
+    sink_t sink = { { 0 }, 0 };
+    
+    ipd_parser_init(&parser);
+    CHECK(ipd_parser_feed(&parser, (const uint8_t *)bad, sizeof(bad) - 1, sink_append, &sink) != 0);
+}
+
+// 吞吐量测试：响应体大小、编码后的流，以及每次输入的长度（相当于一次UART读取）
+#define BENCH_BODY_SIZE    (64 * 1024)
+#define BENCH_STREAM_SIZE  (BENCH_BODY_SIZE + 4096)
+#define BENCH_READ_SIZE    256
+#define BENCH_ROUNDS       200
+
+static uint8_t g_bench_body[BENCH_BODY_SIZE];
+static uint8_t g_bench_stream[BENCH_STREAM_SIZE];
+
+// 吞吐量测试的接收端（只在第一轮比较内容）
+typedef struct {
+    uint32_t received;
+    bool compare;
+    bool mismatch;
+} bench_sink_t;
+
+static int bench_append(const uint8_t *data, uint32_t len, void *ctx)
+{
+    bench_sink_t *sink = (bench_sink_t *)ctx;
+    
+    if (sink->compare &&
+        (sink->received + len > BENCH_BODY_SIZE ||
+         memcmp(data, g_bench_body + sink->received, len) != 0)) {
+        sink->mismatch = true;
+    }
+    sink->received += len;
+    return 0;
+}
+
+/**
+ * @brief 主机单调时钟（微秒）
+ */
+static uint64_t bench_now_us(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief 分块编码响应体（每块1000字节）
+ * @return 编码后的长度
+ */
+static uint32_t bench_encode_chunked(void)
+{
+    uint32_t len = 0;
+    
+    for (uint32_t off = 0; off < BENCH_BODY_SIZE; off += 1000) {
+        uint32_t n = BENCH_BODY_SIZE - off < 1000 ? BENCH_BODY_SIZE - off : 1000;
+        len += (uint32_t)sprintf((char *)g_bench_stream + len, "%lx\r\n", (unsigned long)n);
+        memcpy(g_bench_stream + len, g_bench_body + off, n);
+        len += n;
+        memcpy(g_bench_stream + len, "\r\n", 2);
+        len += 2;
+    }
+    memcpy(g_bench_stream + len, "0\r\n\r\n", 5);
+    return len + 5;
+}
+
+/**
+ * @brief 把响应体分成+IPD帧（每帧1460字节，与模块相同）
+ * @return 编码后的长度
+ */
+static uint32_t bench_encode_ipd(void)
+{
+    uint32_t len = 0;
+    
+    for (uint32_t off = 0; off < BENCH_BODY_SIZE; off += 1460) {
+        uint32_t n = BENCH_BODY_SIZE - off < 1460 ? BENCH_BODY_SIZE - off : 1460;
+        len += (uint32_t)sprintf((char *)g_bench_stream + len, "\r\n+IPD,%lu:", (unsigned long)n);
+        memcpy(g_bench_stream + len, g_bench_body + off, n);
+        len += n;
+    }
+    return len;
+}
+
+/**
+ * @brief 分块解码和+IPD帧解析的吞吐量：每次输入BENCH_READ_SIZE字节，
+ *        重复BENCH_ROUNDS次，按解码得到的响应体字节计算
+ */
+static void test_decode_throughput(void)
+{
+    uint32_t len = bench_encode_chunked();
+    uint64_t start_us = bench_now_us();
+    bench_sink_t sink = { 0, true, false };
+    
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        http_chunk_decoder_t decoder;
+        int ret = HTTP_PARSE_NEED_MORE;
+        
+        http_chunk_decoder_init(&decoder);
+        sink.received = 0;
+        for (uint32_t pos = 0; pos < len && ret == HTTP_PARSE_NEED_MORE; ) {
+            uint32_t n = len - pos < BENCH_READ_SIZE ? len - pos : BENCH_READ_SIZE;
+            uint32_t consumed = 0;
+            ret = http_chunk_decode(&decoder, g_bench_stream + pos, n, bench_append, &sink, &consumed);
+            pos += consumed;
+        }
+        CHECK_EQ(ret, HTTP_PARSE_DONE);
+        CHECK_EQ(sink.received, BENCH_BODY_SIZE);
+        sink.compare = false;
+    }
+    uint64_t chunked_us = bench_now_us() - start_us;
+    CHECK(!sink.mismatch);
+    
+    len = bench_encode_ipd();
+    start_us = bench_now_us();
+    sink.compare = true;
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        ipd_parser_t parser;
+        
+        ipd_parser_init(&parser);
+        sink.received = 0;
+        for (uint32_t pos = 0; pos < len; pos += BENCH_READ_SIZE) {
+            uint32_t n = len - pos < BENCH_READ_SIZE ? len - pos : BENCH_READ_SIZE;
+            CHECK_EQ(ipd_parser_feed(&parser, g_bench_stream + pos, n, bench_append, &sink), 0);
+        }
+        CHECK_EQ(sink.received, BENCH_BODY_SIZE);
+        sink.compare = false;
+    }
+    uint64_t ipd_us = bench_now_us() - start_us;
+    CHECK(!sink.mismatch);
+    
+    uint64_t total = (uint64_t)BENCH_BODY_SIZE * BENCH_ROUNDS;
+    printf("    %u x %u bytes: chunked %llu B/s, +IPD %llu B/s (host)\n",
+           BENCH_ROUNDS, BENCH_BODY_SIZE,
+           (unsigned long long)(total * 1000000 / (chunked_us ? chunked_us : 1)),
+           (unsigned long long)(total * 1000000 / (ipd_us ? ipd_us : 1)));
+}
+
+int main(void)
+{
+    fill_pattern(g_bench_body, sizeof(g_bench_body), 1);
+    
+    TEST_RUN(test_header_fragmented);
+    TEST_RUN(test_header_chunked_and_errors);
+    TEST_RUN(test_chunk_fragmented);
+    TEST_RUN(test_chunk_errors);
+    TEST_RUN(test_ipd_fragmented);
+    TEST_RUN(test_ipd_errors);
+    TEST_RUN(test_decode_throughput);
+    
+    return TEST_RESULT();
+}
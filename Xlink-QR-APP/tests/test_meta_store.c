@@ -0,0 +1,192 @@
+/**
+ * @file test_meta_store.c
+ * @brief 记录区测试：追加、删除、整理，以及任意时刻掉电
+ */
+
+#include "test.h"
+#include "flash_sim.h"
+#include "flash_manager.h"
+#include "meta_store.h"
+#include "stm32_hal_wrapper.h"
+
+#define IMAGE_PATH "test_meta_store.img"
+
+#define TAG_COUNTER   0x0101
+#define TAG_FIXED     0x0102
+#define TAG_LARGE     0x0103
+
+/**
+ * @brief 模拟重新上电
+ */
+static void power_on(void)
+{
+    flash_sim_power_cut(-1);
+    flash_manager_init();
+}
+
+/**
+ * @brief 读取一个32位记录，没有时返回0xFFFFFFFF
+ */
+static uint32_t read_u32(uint16_t tag)
+{
+    uint32_t value;
+    
+    if (meta_store_read(tag, &value, sizeof(value)) != (int)sizeof(value)) {
+        return 0xFFFFFFFF;
+    }
+    return value;
+}
+
+/**
+ * @brief 空记录区、写入、读取、删除
+ */
+static void test_read_write_delete(void)
+{
+    uint8_t large[META_RECORD_MAX_LEN], out[META_RECORD_MAX_LEN];
+    uint32_t value = 7;
+    
+    sim_reset(IMAGE_PATH);
+    
+    CHECK_EQ(meta_store_read(TAG_COUNTER, &value, sizeof(value)), -1);
+    CHECK_EQ(meta_store_delete(TAG_COUNTER), 0);
+    
+    CHECK_EQ(meta_store_write(TAG_COUNTER, &value, sizeof(value)), 0);
+    value = 8;
+    CHECK_EQ(meta_store_write(TAG_COUNTER, &value, sizeof(value)), 0);
+    CHECK_EQ(read_u32(TAG_COUNTER), 8);
+    
+    for (uint32_t i = 0; i < sizeof(large); i++) {
+        large[i] = (uint8_t)(i * 3);
+    }
+    CHECK_EQ(meta_store_write(TAG_LARGE, large, sizeof(large)), 0);
+    CHECK(meta_store_write(TAG_LARGE, large, META_RECORD_MAX_LEN + 1) != 0);
+    CHECK(meta_store_write(0xFFFF, &value, sizeof(value)) != 0);
+    
+    // 缓冲区较小时只复制一部分，返回记录长度
+    CHECK_EQ(meta_store_read(TAG_LARGE, out, 10), META_RECORD_MAX_LEN);
+    CHECK_MEM(out, large, 10);
+    
+    // 重新上电后记录仍在
+    power_on();
+    CHECK_EQ(read_u32(TAG_COUNTER), 8);
+    CHECK_EQ(meta_store_read(TAG_LARGE, out, sizeof(out)), META_RECORD_MAX_LEN);
+    CHECK_MEM(out, large, sizeof(large));
+    
+    CHECK_EQ(meta_store_delete(TAG_COUNTER), 0);
+    CHECK_EQ(meta_store_read(TAG_COUNTER, &value, sizeof(value)), -1);
+    power_on();
+    CHECK_EQ(meta_store_read(TAG_COUNTER, &value, sizeof(value)), -1);
+    CHECK_EQ(meta_store_read(TAG_LARGE, out, sizeof(out)), META_RECORD_MAX_LEN);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 整理：写满多页后只保留各类型的最新记录，删除的记录不再出现
+ */
+static void test_compaction(void)
+{
+    uint32_t fixed = 921600, deleted = 1;
+    flash_sim_stats_t stats;
+    
+    sim_reset(IMAGE_PATH);
+    
+    CHECK_EQ(meta_store_write(TAG_FIXED, &fixed, sizeof(fixed)), 0);
+    CHECK_EQ(meta_store_write(TAG_LARGE, &deleted, sizeof(deleted)), 0);
+    CHECK_EQ(meta_store_delete(TAG_LARGE), 0);
+    
+    flash_sim_reset_stats();
+    for (uint32_t i = 0; i < 1000; i++) {
+        CHECK_EQ(meta_store_write(TAG_COUNTER, &i, sizeof(i)), 0);
+    }
+    
+    CHECK_EQ(read_u32(TAG_COUNTER), 999);
+    CHECK_EQ(read_u32(TAG_FIXED), fixed);
+    CHECK_EQ(read_u32(TAG_LARGE), 0xFFFFFFFF);
+    
+    // 每页约63条16字节的记录，整理后剩余空间可再写60条左右
+    flash_sim_get_stats(&stats);
+    CHECK(stats.page_erases >= 1000 / 64 && stats.page_erases <= 1000 / 56);
+    CHECK_EQ(flash_sim_get_erase_count(SYSDATA_BASE_ADDR) +
+             flash_sim_get_erase_count(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE), stats.page_erases);
+    
+    power_on();
+    CHECK_EQ(read_u32(TAG_COUNTER), 999);
+    CHECK_EQ(read_u32(TAG_FIXED), fixed);
+    CHECK_EQ(read_u32(TAG_LARGE), 0xFFFFFFFF);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 在写入和整理的每一次Flash操作处掉电：重新上电后记录是旧值或新值，
+ *        其他记录不丢失，之后可以继续写入
+ */
+static void test_power_loss(void)
+{
+    uint32_t fixed = 460800;
+    uint32_t last = 0;
+    int32_t cuts = 0;
+    
+    sim_reset(IMAGE_PATH);
+    CHECK_EQ(meta_store_write(TAG_FIXED, &fixed, sizeof(fixed)), 0);
+    CHECK_EQ(meta_store_write(TAG_COUNTER, &last, sizeof(last)), 0);
+    
+    // 掉电点覆盖记录中间（8个半字）和整理过程（擦除、复制两条记录、页头、新记录，
+    // 约30次操作）；每次循环写两条，几十次循环触发一次整理
+    for (int32_t cut = 0; cut < 400; cut++) {
+        uint32_t next = last + 1;
+        
+        flash_sim_power_cut(cut % 32);
+        if (meta_store_write(TAG_COUNTER, &next, sizeof(next)) != 0) {
+            cuts++;
+        }
+        power_on();
+        
+        uint32_t value = read_u32(TAG_COUNTER);
+        CHECK(value == last || value == next);
+        CHECK_EQ(read_u32(TAG_FIXED), fixed);
+        
+        last = value + 1;
+        CHECK_EQ(meta_store_write(TAG_COUNTER, &last, sizeof(last)), 0);
+        CHECK_EQ(read_u32(TAG_COUNTER), last);
+    }
+    
+    // 掉电确实发生在写入过程中
+    CHECK(cuts > 90);
+    
+    flash_sim_close();
+}
+
+/**
+ * @brief 两页都损坏时重新格式化
+ */
+static void test_format_after_corruption(void)
+{
+    uint32_t value = 5;
+    
+    sim_reset(IMAGE_PATH);
+    CHECK_EQ(meta_store_write(TAG_COUNTER, &value, sizeof(value)), 0);
+    
+    CHECK_EQ(flash_erase_page(SYSDATA_BASE_ADDR), 0);
+    CHECK_EQ(flash_erase_page(SYSDATA_BASE_ADDR + FLASH_PAGE_SIZE), 0);
+    power_on();
+    
+    CHECK_EQ(read_u32(TAG_COUNTER), 0xFFFFFFFF);
+    CHECK_EQ(meta_store_write(TAG_COUNTER, &value, sizeof(value)), 0);
+    power_on();
+    CHECK_EQ(read_u32(TAG_COUNTER), value);
+    
+    flash_sim_close();
+}
+
+int main(void)
+{
+    TEST_RUN(test_read_write_delete);
+    TEST_RUN(test_compaction);
+    TEST_RUN(test_power_loss);
+    TEST_RUN(test_format_after_corruption);
+    
+    remove(IMAGE_PATH);
+    return TEST_RESULT();
+}